@@ -0,0 +1,474 @@
+/*  Ball arithmetic.  A BALL is a FLOAT midpoint and a FLOAT radius
+	which together bound the true value.  Every operation adds a bound
+	on the rounding of its midpoint to the propagated radius.  Midpoints
+	are computed at bf_work_limbs words, so a calculation can be run
+	short, checked with bf_ball_bits and run again longer only if the
+	radius came out too wide.
+	The bounds come from how the basic operations truncate.  bf_add
+	works on the whole mantissa and is off by less than 3 ulps of the
+	larger operand.  bf_multiply and bf_square drop the columns below
+	limbs words and are off by less than 8*(limbs+1) ulps of the result
+	at that length.  Divide and sqrt are checked with their residuals,
+	which only need those two.  exp, sine and cosine are summed as
+	Taylor series in balls with a bound on the tail, sine and cosine
+	after Payne-Hanek reduction and with an enclosure of PI/2, so no
+	library function is taken on trust.
+*/
+
+#include <stdio.h>
+#include "bigfloat.h"
+#include "multipoly.h"
+
+extern int bf_work_limbs;
+
+/*  radius only needs a few good bits.  Each radius result is pushed
+	up by 2^-BALL_RAD_BITS relative, far more than the rounding of
+	the few adds and multiplies of positive values that made it.
+*/
+
+#define	BALL_RAD_BITS	30
+
+/*  bf_add is good to this many bits below the exponent of the
+	larger operand
+*/
+
+#define	ADD_BITS		(32*MNTSA_SIZE - 3)
+
+static BALL	p2ball;			/*  encloses PI/2, see ball_p2  */
+static int	p2ready = 0;
+
+/*  number of bits below the exponent of the result bf_multiply and
+	bf_square are good to at the current bf_work_limbs.  2^(4 + loss)
+	covers 8*(limbs+1) ulps at limbs words.
+*/
+
+static int mul_bits( void)
+{
+	int		limbs, loss;
+
+	limbs = bf_work_limbs;
+	if( limbs < 2) limbs = 2;
+	if( limbs > MNTSA_SIZE) limbs = MNTSA_SIZE;
+	loss = 4;
+	while( (1 << (loss - 4)) < limbs + 1) loss++;
+	return 32*limbs - loss;
+}
+
+/*  b = |a|  */
+
+static void ball_abs( FLOAT *a, FLOAT *b)
+{
+	bf_copy( a, b);
+	if( b->mntsa.e[MS_MNTSA] & SIGN_BIT) bf_negate( b);
+}
+
+/*  add 2^(expnt - bits) to r  */
+
+static void ball_err( long expnt, int bits, FLOAT *r)
+{
+	FLOAT	u;
+
+	bf_one( &u);
+	u.expnt = expnt - bits + 1;
+	bf_add( r, &u, r);
+}
+
+/*  add the error of bf_add( a, b) to r.  Exact if either is zero.  */
+
+static void add_err( FLOAT *a, FLOAT *b, FLOAT *r)
+{
+	if( bf_iszero( a) || bf_iszero( b)) return;
+	ball_err( (a->expnt > b->expnt) ? a->expnt : b->expnt, ADD_BITS, r);
+}
+
+/*  add the error of a product c to r  */
+
+static void mul_err( FLOAT *c, FLOAT *r)
+{
+	if( bf_iszero( c)) return;
+	ball_err( c->expnt, mul_bits(), r);
+}
+
+/*  round radius up  */
+
+static void rad_up( FLOAT *r)
+{
+	FLOAT	u;
+
+	if( bf_iszero( r)) return;
+	bf_one( &u);
+	u.expnt = r->expnt - BALL_RAD_BITS;
+	bf_add( r, &u, r);
+}
+
+/*  low = a lower bound on m - r for m > 0, r >= 0.  The two subtracts
+	are each off by less than 2^(m.expnt - ADD_BITS), so taking twice
+	that off covers both.  returns 0 if the bound isn't positive.
+*/
+
+static int ball_low( FLOAT *m, FLOAT *r, FLOAT *low)
+{
+	FLOAT	u;
+	long	e;
+
+	e = m->expnt;
+	if( !bf_iszero( r) && (r->expnt > e)) return 0;
+	bf_subtract( m, r, low);
+	bf_one( &u);
+	u.expnt = e - ADD_BITS + 2;
+	bf_subtract( low, &u, low);
+	if( bf_iszero( low) || (low->mntsa.e[MS_MNTSA] & SIGN_BIT)) return 0;
+	return 1;
+}
+
+/*  q = a/b and e a bound on |q - a/b|, b not zero.  bf_divide is
+	checked with its residual: |a - q*b| is at most |a - p| plus the
+	errors of p = q*b and of the subtract, and |b| >= 2^(b.expnt - 1).
+	q and e can't be a or b.
+*/
+
+static void div_err( FLOAT *a, FLOAT *b, FLOAT *q, FLOAT *e)
+{
+	FLOAT	p, d;
+
+	bf_divide( a, b, q);
+	bf_multiply( q, b, &p);
+	bf_subtract( a, &p, &d);
+	ball_abs( &d, e);
+	mul_err( &p, e);
+	add_err( a, &p, e);
+	if( !bf_iszero( e)) e->expnt += 1 - b->expnt;
+}
+
+/*  r = an upper bound on x/y for x >= 0, y > 0  */
+
+static void div_up( FLOAT *x, FLOAT *y, FLOAT *r)
+{
+	FLOAT	q, e;
+
+	div_err( x, y, &q, &e);
+	bf_add( &q, &e, r);
+}
+
+/*  m = |mid| + rad, at least the magnitude of anything in a  */
+
+static void ball_mag( BALL *a, FLOAT *m)
+{
+	ball_abs( &a->mid, m);
+	bf_add( m, &a->rad, m);
+	rad_up( m);
+}
+
+/*  make an exact ball from a FLOAT  */
+
+void bf_ball_set( FLOAT *x, BALL *b)
+{
+	bf_copy( x, &b->mid);
+	bf_null( &b->rad);
+}
+
+void bf_ball_copy( BALL *a, BALL *b)
+{
+	bf_copy( &a->mid, &b->mid);
+	bf_copy( &a->rad, &b->rad);
+}
+
+/*  number of bits of the midpoint that can be trusted.  0 if the
+	ball holds zero.
+*/
+
+int bf_ball_bits( BALL *b)
+{
+	int		bits;
+
+	if( bf_iszero( &b->rad)) return 32*MNTSA_SIZE - 2;
+	if( bf_iszero( &b->mid)) return 0;
+	bits = b->mid.expnt - b->rad.expnt - 1;
+	if( bits < 0) bits = 0;
+	if( bits > 32*MNTSA_SIZE - 2) bits = 32*MNTSA_SIZE - 2;
+	return bits;
+}
+
+/*  c = a + b.  rad = ra + rb + rounding, which goes by the larger
+	operand, not the result, so cancellation is covered.
+*/
+
+void bf_ball_add( BALL *a, BALL *b, BALL *c)
+{
+	FLOAT	r, m;
+
+	bf_add( &a->rad, &b->rad, &r);
+	bf_add( &a->mid, &b->mid, &m);
+	add_err( &a->mid, &b->mid, &r);
+	rad_up( &r);
+	bf_copy( &m, &c->mid);
+	bf_copy( &r, &c->rad);
+}
+
+/*  c = a - b  */
+
+void bf_ball_subtract( BALL *a, BALL *b, BALL *c)
+{
+	BALL	myb;
+
+	bf_ball_copy( b, &myb);
+	bf_negate( &myb.mid);
+	bf_ball_add( a, &myb, c);
+}
+
+/*  c = a * b.  rad = |ma|*rb + |mb|*ra + ra*rb + rounding  */
+
+void bf_ball_multiply( BALL *a, BALL *b, BALL *c)
+{
+	FLOAT	r, m, am, bm, temp;
+
+	ball_abs( &a->mid, &am);
+	ball_abs( &b->mid, &bm);
+	bf_multiply( &am, &b->rad, &r);
+	bf_multiply( &bm, &a->rad, &temp);
+	bf_add( &r, &temp, &r);
+	bf_multiply( &a->rad, &b->rad, &temp);
+	bf_add( &r, &temp, &r);
+	bf_multiply( &a->mid, &b->mid, &m);
+	mul_err( &m, &r);
+	rad_up( &r);
+	bf_copy( &m, &c->mid);
+	bf_copy( &r, &c->rad);
+}
+
+/*  c = a / b.  Returns 0 if b holds zero, 1 otherwise.
+	rad = (|ma|*rb + |mb|*ra)/(|mb|*(|mb| - rb)) + rounding, with
+	the denominator taken low and the quotients checked by div_err.
+*/
+
+int bf_ball_divide( BALL *a, BALL *b, BALL *c)
+{
+	FLOAT	r, am, bm, low, q, e, temp;
+
+	if( bf_iszero( &b->mid)) return 0;
+	ball_abs( &b->mid, &bm);
+	if( !ball_low( &bm, &b->rad, &low)) return 0;
+	ball_abs( &a->mid, &am);
+	bf_multiply( &am, &b->rad, &r);
+	bf_multiply( &bm, &a->rad, &temp);
+	bf_add( &r, &temp, &r);
+	if( !bf_iszero( &r))
+	{
+		bf_multiply( &bm, &low, &temp);
+		bf_null( &e);
+		mul_err( &temp, &e);
+		if( !ball_low( &temp, &e, &low)) return 0;
+		div_up( &r, &low, &r);
+	}
+	div_err( &a->mid, &b->mid, &q, &e);
+	bf_add( &r, &e, &r);
+	rad_up( &r);
+	bf_copy( &q, &c->mid);
+	bf_copy( &r, &c->rad);
+	return 1;
+}
+
+/*  b = sqrt(a).  Returns 0 if a holds zero or negatives, 1 otherwise.
+	|sqrt(x) - sqrt(m)| = |x - m|/(sqrt(x) + sqrt(m)) so the radius
+	carried over is r/sqrt(m).  s = bf_square_root(m) is checked with
+	its residual, |s - sqrt(m)| = |s^2 - m|/(s + sqrt(m)) <= |s^2 - m|/s,
+	and s less that error is the low bound for sqrt(m).
+*/
+
+int bf_ball_sqrt( BALL *a, BALL *b)
+{
+	FLOAT	r, s, p, d, e, low;
+
+	if( bf_iszero( &a->mid) || (a->mid.mntsa.e[MS_MNTSA] & SIGN_BIT))
+		return 0;
+	if( !ball_low( &a->mid, &a->rad, &low)) return 0;
+	bf_square_root( &a->mid, &s);
+	bf_square( &s, &p);
+	bf_subtract( &p, &a->mid, &d);
+	ball_abs( &d, &e);
+	mul_err( &p, &e);
+	add_err( &p, &a->mid, &e);
+	if( !bf_iszero( &e)) e.expnt += 1 - s.expnt;
+	if( !ball_low( &s, &e, &low)) return 0;
+	if( bf_iszero( &a->rad)) bf_null( &r);
+	else div_up( &a->rad, &low, &r);
+	bf_add( &r, &e, &r);
+	rad_up( &r);
+	bf_copy( &s, &b->mid);
+	bf_copy( &r, &b->rad);
+	return 1;
+}
+
+/*  b = exp(a).  Returns 0 if a reaches 2^30, where the exponent of
+	the result could overflow, 1 otherwise.
+	y = a/2^s is below 1 in magnitude and exp(y) is summed as a Taylor
+	series.  Each term is at most half the one before, so what is left
+	after the last term taken is less than that term.  Squaring s times
+	gives exp(a).  The radius of a goes through all of it as a ball.
+*/
+
+int bf_ball_exp( BALL *a, BALL *b)
+{
+	BALL	y, term, sum, k;
+	FLOAT	m;
+	int		s, n;
+
+	ball_mag( a, &m);
+	if( !bf_iszero( &m) && (m.expnt > 30)) return 0;
+	s = (bf_iszero( &m) || (m.expnt < 0)) ? 0 : m.expnt;
+	bf_ball_copy( a, &y);
+	if( !bf_iszero( &y.mid)) y.mid.expnt -= s;
+	if( !bf_iszero( &y.rad)) y.rad.expnt -= s;
+	bf_one( &k.mid);
+	bf_null( &k.rad);
+	bf_ball_add( &k, &y, &sum);
+	bf_ball_copy( &y, &term);
+	for( n=2; ; n++)
+	{
+		ball_mag( &term, &m);
+		if( bf_iszero( &m) || (m.expnt < -32*bf_work_limbs - 2)) break;
+		bf_ball_multiply( &term, &y, &term);
+		bf_int_to_float( n, &k.mid);
+		bf_ball_divide( &term, &k, &term);
+		bf_ball_add( &sum, &term, &sum);
+	}
+	bf_add( &sum.rad, &m, &sum.rad);
+	rad_up( &sum.rad);
+	for( ; s>0; s--) bf_ball_multiply( &sum, &sum, &sum);
+	bf_ball_copy( &sum, b);
+	return 1;
+}
+
+/*  ball around PI/2 = 1/(2/PI), from the 2/PI table at full length.
+	The table is truncated below 2^-(32*MNTSA_SIZE - 1).
+*/
+
+static void ball_p2( void)
+{
+	BALL	one, t;
+	int		save;
+
+	if( p2ready) return;
+	save = bf_work_limbs;
+	bf_work_limbs = MNTSA_SIZE;
+	bf_two_over_pi( &t.mid);
+	bf_one( &t.rad);
+	t.rad.expnt = 2 - 32*MNTSA_SIZE;
+	bf_one( &one.mid);
+	bf_null( &one.rad);
+	bf_ball_divide( &one, &t, &p2ball);
+	bf_work_limbs = save;
+	p2ready = 1;
+}
+
+/*  y = sin(u) or cos(u) for u below 1 in magnitude, Taylor series in
+	balls.  Terms fall by 6 or more each step and alternate, so what
+	is left after the last term taken is less than that term.
+*/
+
+static void ball_taylor( BALL *u, BALL *y, int sineflag)
+{
+	BALL	u2, term, k;
+	FLOAT	m;
+	long	stop;
+	int		n;
+
+	bf_ball_multiply( u, u, &u2);
+	bf_negate( &u2.mid);
+	if( sineflag) bf_ball_copy( u, &term);
+	else
+	{
+		bf_one( &term.mid);
+		bf_null( &term.rad);
+	}
+	bf_ball_copy( &term, y);
+	ball_mag( &term, &m);
+	if( bf_iszero( &m)) return;
+	stop = m.expnt - 32*bf_work_limbs - 2;
+	bf_null( &k.rad);
+	n = sineflag ? 2 : 1;
+	while( 1)
+	{
+		bf_ball_multiply( &term, &u2, &term);
+		bf_int_to_float( n*(n + 1), &k.mid);
+		bf_ball_divide( &term, &k, &term);
+		bf_ball_add( y, &term, y);
+		n += 2;
+		ball_mag( &term, &m);
+		if( bf_iszero( &m) || (m.expnt < stop)) break;
+	}
+	bf_add( &y->rad, &m, &y->rad);
+	rad_up( &y->rad);
+}
+
+/*  sine and cosine have slope at most 1, so the radius of a is added
+	at the end and the midpoint is worked on as exact.  Below 1 the
+	series takes it directly.  Up to PH_MAXEXP Payne-Hanek gives the
+	quadrant and a fraction t which is below the true one by less than
+	an ulp of t plus 2^-(32*MNTSA_SIZE + PH_GUARD); t goes through the
+	rest as a ball times the PI/2 ball.  Past PH_MAXEXP the ball is all
+	of -1 ... 1.
+*/
+
+static void ball_trig( BALL *a, BALL *b, int sineflag)
+{
+	BALL	t, u, one;
+	FLOAT	ar, half;
+	int		quad;
+
+	if( !bf_iszero( &a->mid) && (a->mid.expnt > PH_MAXEXP))
+	{
+		bf_null( &b->mid);
+		bf_one( &b->rad);
+		return;
+	}
+	bf_copy( &a->rad, &ar);
+	quad = 0;
+	if( bf_iszero( &a->mid) || (a->mid.expnt <= 0)) bf_ball_set( &a->mid, &u);
+	else
+	{
+		quad = bf_ph_reduce( &a->mid, &t.mid);
+		bf_one( &t.rad);
+		t.rad.expnt = 1 - 32*MNTSA_SIZE - PH_GUARD;
+		if( !bf_iszero( &t.mid))
+			ball_err( t.mid.expnt, 32*MNTSA_SIZE - 1, &t.rad);
+		bf_one( &half);
+		half.expnt--;
+		if( !bf_iszero( &t.mid) && (bf_compare( &t.mid, &half) > 0))
+		{
+			bf_one( &one.mid);
+			bf_null( &one.rad);
+			if( t.mid.mntsa.e[MS_MNTSA] & SIGN_BIT)
+			{
+				bf_ball_add( &t, &one, &t);
+				quad--;
+			}
+			else
+			{
+				bf_ball_subtract( &t, &one, &t);
+				quad++;
+			}
+		}
+		ball_p2();
+		bf_ball_multiply( &t, &p2ball, &u);
+	}
+
+/*  sin(x) = cos(x - PI/2), then cos, -sin, -cos, sin by quadrant  */
+
+	if( sineflag) quad += 3;
+	quad &= 3;
+	ball_taylor( &u, b, quad & 1);
+	if( (quad == 1) || (quad == 2)) bf_negate( &b->mid);
+	bf_add( &b->rad, &ar, &b->rad);
+	rad_up( &b->rad);
+}
+
+void bf_ball_cosine( BALL *a, BALL *b)
+{
+	ball_trig( a, b, 0);
+}
+
+void bf_ball_sine( BALL *a, BALL *b)
+{
+	ball_trig( a, b, 1);
+}
@@ -0,0 +1,491 @@
+/*  Batch arithmetic.  The same operation on count independent values.
+	Multiplies are done BF_LANES values at a time with the mantissas
+	turned sideways, word i of every lane next to each other, so the
+	inner loops run across lanes with no carries between them.  A
+	compiler targeting AVX2 or AVX-512 turns those loops into vector
+	32x32->64 multiplies and adds.  Each column of partial products is
+	summed exactly, low and high halves apart, so results are bit for
+	bit the same as bf_multiply at bf_work_limbs words.
+	Adds shift each value by its own exponent difference so they are
+	done one at a time with bf_add.
+	The same operations work on BFARRAY storage, where words are
+	already sideways and only the signs need fixing on the way in.
+*/
+
+#include <stdio.h>
+#include "bigfloat.h"
+#include "multipoly.h"
+
+extern RAMDATA ram_block[];
+extern int bf_work_limbs;
+
+/*  c = a*b on BF_LANES unsigned mantissas, word i of lane l at
+	[i*BF_LANES + l].  Only the top limbs words are used.  Lowest
+	column keeps only the high halves of its products same as
+	bf_multiply_limbs, every column above is exact.
+*/
+
+static void mul_lanes( ELEMENT *a, ELEMENT *b, int limbs, ELEMENT *c)
+{
+	unsigned long long	lo[BF_LANES], hi[BF_LANES], hiprev[BF_LANES];
+	unsigned long long	carry[BF_LANES], p, s;
+	int		i, j, k, l, t, low;
+
+	low = MNTSA_SIZE - limbs;
+	for( l=0; l<BF_LANES; l++)
+	{
+		hiprev[l] = 0;
+		carry[l] = 0;
+	}
+	for( i=0; i<low*BF_LANES; i++) c[i] = 0;
+	for( j=low; j<MNTSA_SIZE; j++)
+	{
+		k = MS_MNTSA + low - j;
+		for( l=0; l<BF_LANES; l++)
+			hiprev[l] += ((unsigned long long)a[j*BF_LANES + l] *
+					(unsigned long long)b[k*BF_LANES + l]) >> 32;
+	}
+
+/*  word t gets low halves of column t and high halves of column t-1  */
+
+	for( t=low; t<MNTSA_SIZE; t++)
+	{
+		for( l=0; l<BF_LANES; l++)
+		{
+			lo[l] = 0;
+			hi[l] = 0;
+		}
+		for( j=t+1; j<MNTSA_SIZE; j++)
+		{
+			k = t + MNTSA_SIZE - j;
+			for( l=0; l<BF_LANES; l++)
+			{
+				p = (unsigned long long)a[j*BF_LANES + l] *
+					(unsigned long long)b[k*BF_LANES + l];
+				lo[l] += p & 0xffffffffLL;
+				hi[l] += p >> 32;
+			}
+		}
+		for( l=0; l<BF_LANES; l++)
+		{
+			s = carry[l] + lo[l] + hiprev[l];
+			c[t*BF_LANES + l] = s & 0xffffffffLL;
+			carry[l] = s >> 32;
+			hiprev[l] = hi[l];
+		}
+	}
+}
+
+/*  turn m values sideways into lane storage as magnitudes,
+	unused lanes are zero.  returns sign bits, bit l for lane l.
+*/
+
+static int to_lanes( FLOAT **x, int m, ELEMENT *lanes)
+{
+	unsigned long long	sum;
+	int		i, l, signs;
+
+	signs = 0;
+	for( l=0; l<BF_LANES; l++)
+	{
+		if( l >= m)
+		{
+			OPLOOP(i) lanes[i*BF_LANES + l] = 0;
+			continue;
+		}
+		if( !(x[l]->mntsa.e[MS_MNTSA] & SIGN_BIT))
+		{
+			OPLOOP(i) lanes[i*BF_LANES + l] = x[l]->mntsa.e[i];
+			continue;
+		}
+		signs |= 1 << l;
+		sum = 1;
+		OPLOOP(i)
+		{
+			sum += (~x[l]->mntsa.e[i]) & 0xffffffffLL;
+			lanes[i*BF_LANES + l] = sum & 0xffffffffLL;
+			sum >>= 32;
+		}
+	}
+	return signs;
+}
+
+/*  words used by the multiply kernel  */
+
+static int lane_limbs( void)
+{
+	if( bf_work_limbs < 2) return 2;
+	if( bf_work_limbs > MNTSA_SIZE) return MNTSA_SIZE;
+	return bf_work_limbs;
+}
+
+/*  lane l of a kernel result to a signed, normalized FLOAT  */
+
+static void from_lanes( ELEMENT *lanes, int l, long expnt, int neg, FLOAT *c)
+{
+	int		i;
+
+	c->expnt = expnt;
+	OPLOOP(i) c->mntsa.e[i] = lanes[i*BF_LANES + l];
+	bf_normal( c);
+	if( neg) bf_negate( c);
+}
+
+/*  c[l] = a[l]*b[l] for l < m <= BF_LANES.  c must not be a or b.  */
+
+static void mul_chunk( FLOAT **a, FLOAT **b, int m, FLOAT *c)
+{
+	ELEMENT	al[MNTSA_SIZE*BF_LANES], bl[MNTSA_SIZE*BF_LANES];
+	ELEMENT	cl[MNTSA_SIZE*BF_LANES];
+	int		l, signs;
+
+	signs = to_lanes( a, m, al) ^ to_lanes( b, m, bl);
+	mul_lanes( al, bl, lane_limbs(), cl);
+	for( l=0; l<m; l++)
+		from_lanes( cl, l, a[l]->expnt + b[l]->expnt + 1, (signs >> l) & 1, &c[l]);
+}
+
+/*  c[i] = a[i] + b[i], i = 0 ... count-1.  any arrays can be the same.  */
+
+void bf_add_n( FLOAT *a, FLOAT *b, int count, FLOAT *c)
+{
+	int		i;
+
+	for( i=0; i<count; i++) bf_add( &a[i], &b[i], &c[i]);
+}
+
+/*  c[i] = a[i] * b[i], same results as bf_multiply.
+	any arrays can be the same.
+*/
+
+void bf_mul_n( FLOAT *a, FLOAT *b, int count, FLOAT *c)
+{
+	FLOAT	*pa[BF_LANES], *pb[BF_LANES], t[BF_LANES];
+	int		i, l, m;
+
+	for( i=0; i<count; i+=BF_LANES)
+	{
+		m = (count - i < BF_LANES) ? count - i : BF_LANES;
+		for( l=0; l<m; l++)
+		{
+			pa[l] = &a[i + l];
+			pb[l] = &b[i + l];
+		}
+		mul_chunk( pa, pb, m, t);
+		for( l=0; l<m; l++) bf_copy( &t[l], &c[i + l]);
+	}
+}
+
+/*  c[i] = a[i] * b[i] + c[i], product rounded same as bf_multiply
+	then added.  any arrays can be the same.
+*/
+
+void bf_fma_n( FLOAT *a, FLOAT *b, int count, FLOAT *c)
+{
+	FLOAT	*pa[BF_LANES], *pb[BF_LANES], t[BF_LANES];
+	int		i, l, m;
+
+	for( i=0; i<count; i+=BF_LANES)
+	{
+		m = (count - i < BF_LANES) ? count - i : BF_LANES;
+		for( l=0; l<m; l++)
+		{
+			pa[l] = &a[i + l];
+			pb[l] = &b[i + l];
+		}
+		mul_chunk( pa, pb, m, t);
+		for( l=0; l<m; l++) bf_add( &t[l], &c[i + l], &c[i + l]);
+	}
+}
+
+void bf_add_n_cmplx( COMPLEX *a, COMPLEX *b, int count, COMPLEX *c)
+{
+	int		i;
+
+	for( i=0; i<count; i++) bf_add_cmplx( &a[i], &b[i], &c[i]);
+}
+
+/*  complex products of up to BF_LANES pairs into c, same formulas
+	and so same results as bf_multiply_cmplx.  c must not be a or b.
+*/
+
+static void mul_chunk_cmplx( COMPLEX *a, COMPLEX *b, int m, COMPLEX *c)
+{
+	FLOAT	*p1[BF_LANES], *p2[BF_LANES], s1[BF_LANES], s2[BF_LANES];
+	FLOAT	k1[BF_LANES], k2[BF_LANES], k3[BF_LANES], k4[BF_LANES];
+	int		l;
+
+	if( MNTSA_SIZE >= GAUSS_MNTSA)
+	{
+		for( l=0; l<m; l++)
+		{
+			bf_add( &a[l].real, &a[l].imag, &s1[l]);
+			p1[l] = &b[l].real;
+			p2[l] = &s1[l];
+		}
+		mul_chunk( p1, p2, m, k1);
+		for( l=0; l<m; l++)
+		{
+			bf_subtract( &b[l].imag, &b[l].real, &s1[l]);
+			bf_add( &b[l].real, &b[l].imag, &s2[l]);
+			p1[l] = &a[l].real;
+		}
+		mul_chunk( p1, p2, m, k2);
+		for( l=0; l<m; l++)
+		{
+			p1[l] = &a[l].imag;
+			p2[l] = &s2[l];
+		}
+		mul_chunk( p1, p2, m, k3);
+		for( l=0; l<m; l++)
+		{
+			bf_subtract( &k1[l], &k3[l], &c[l].real);
+			bf_add( &k1[l], &k2[l], &c[l].imag);
+		}
+		return;
+	}
+	for( l=0; l<m; l++)
+	{
+		p1[l] = &a[l].real;
+		p2[l] = &b[l].real;
+	}
+	mul_chunk( p1, p2, m, k1);
+	for( l=0; l<m; l++)
+	{
+		p1[l] = &a[l].imag;
+		p2[l] = &b[l].imag;
+	}
+	mul_chunk( p1, p2, m, k2);
+	for( l=0; l<m; l++)
+	{
+		p1[l] = &a[l].real;
+		p2[l] = &b[l].imag;
+	}
+	mul_chunk( p1, p2, m, k3);
+	for( l=0; l<m; l++)
+	{
+		p1[l] = &a[l].imag;
+		p2[l] = &b[l].real;
+	}
+	mul_chunk( p1, p2, m, k4);
+	for( l=0; l<m; l++)
+	{
+		bf_subtract( &k1[l], &k2[l], &c[l].real);
+		bf_add( &k3[l], &k4[l], &c[l].imag);
+	}
+}
+
+/*  c[i] = a[i] * b[i] for complex arrays.  any arrays can be the same.  */
+
+void bf_mul_n_cmplx( COMPLEX *a, COMPLEX *b, int count, COMPLEX *c)
+{
+	COMPLEX	t[BF_LANES];
+	int		i, l, m;
+
+	for( i=0; i<count; i+=BF_LANES)
+	{
+		m = (count - i < BF_LANES) ? count - i : BF_LANES;
+		mul_chunk_cmplx( &a[i], &b[i], m, t);
+		for( l=0; l<m; l++) bf_copy_cmplx( &t[l], &c[i + l]);
+	}
+}
+
+/*  c[i] = a[i] * b[i] + c[i] for complex arrays.  */
+
+void bf_fma_n_cmplx( COMPLEX *a, COMPLEX *b, int count, COMPLEX *c)
+{
+	COMPLEX	t[BF_LANES];
+	int		i, l, m;
+
+	for( i=0; i<count; i+=BF_LANES)
+	{
+		m = (count - i < BF_LANES) ? count - i : BF_LANES;
+		mul_chunk_cmplx( &a[i], &b[i], m, t);
+		for( l=0; l<m; l++) bf_add_cmplx( &t[l], &c[i + l], &c[i + l]);
+	}
+}
+
+/*  number of FLOATs of pool space v needs: a row of exponents and
+	MNTSA_SIZE rows of words, each ArrayStride(v) long.
+*/
+
+static ELEMENT array_floats( BFARRAY *v)
+{
+	ELEMENT	bytes;
+
+	bytes = ArrayStride( *v)*(sizeof(long) + MNTSA_SIZE*sizeof(ELEMENT));
+	return (bytes + sizeof(FLOAT) - 1)/sizeof(FLOAT);
+}
+
+/*  get space for v.count values.  returns 0 if no room, v is left
+	alone.
+*/
+
+int bf_array_alloc( BFARRAY *v)
+{
+	MULTIPOLY	p;
+
+	if( v->count < 1) return 0;
+	p.degree = array_floats( v) - 1;
+	if( !bf_get_space( &p)) return 0;
+	v->memdex = p.memdex;
+	return 1;
+}
+
+void bf_array_free( BFARRAY *v)
+{
+	MULTIPOLY	p;
+
+	p.degree = array_floats( v) - 1;
+	p.memdex = v->memdex;
+	bf_free_space( &p);
+}
+
+/*  value i of v = x  */
+
+void bf_array_store( BFARRAY v, int i, FLOAT *x)
+{
+	ELEMENT	*w;
+	int		k;
+
+	ArrayExpnt( v)[i] = x->expnt;
+	w = ArrayWord( v, 0) + i;
+	OPLOOP(k) w[k*ArrayStride( v)] = x->mntsa.e[k];
+}
+
+/*  x = value i of v  */
+
+void bf_array_load( BFARRAY v, int i, FLOAT *x)
+{
+	ELEMENT	*w;
+	int		k;
+
+	x->expnt = ArrayExpnt( v)[i];
+	w = ArrayWord( v, 0) + i;
+	OPLOOP(k) x->mntsa.e[k] = w[k*ArrayStride( v)];
+}
+
+/*  value i of v = x[index[i]] for all v.count values.  index 0
+	means x[i], so a MULTIPOLY's coefficients load with
+	bf_array_gather( Address( poly), 0, v).
+*/
+
+void bf_array_gather( FLOAT *x, int *index, BFARRAY v)
+{
+	int		i;
+
+	for( i=0; i<v.count; i++)
+		bf_array_store( v, i, index ? &x[index[i]] : &x[i]);
+}
+
+/*  x[index[i]] = value i of v, index 0 means x[i]  */
+
+void bf_array_scatter( BFARRAY v, int *index, FLOAT *x)
+{
+	int		i;
+
+	for( i=0; i<v.count; i++)
+		bf_array_load( v, i, index ? &x[index[i]] : &x[i]);
+}
+
+/*  m values of v from first into lanes as magnitudes, same as
+	to_lanes.
+*/
+
+static int array_to_lanes( BFARRAY v, int first, int m, ELEMENT *lanes)
+{
+	unsigned long long	sum;
+	ELEMENT	*w;
+	int		i, l, signs;
+
+	signs = 0;
+	for( l=0; l<BF_LANES; l++)
+	{
+		if( l >= m)
+		{
+			OPLOOP(i) lanes[i*BF_LANES + l] = 0;
+			continue;
+		}
+		w = ArrayWord( v, 0) + first + l;
+		if( !(w[MS_MNTSA*ArrayStride( v)] & SIGN_BIT))
+		{
+			OPLOOP(i) lanes[i*BF_LANES + l] = w[i*ArrayStride( v)];
+			continue;
+		}
+		signs |= 1 << l;
+		sum = 1;
+		OPLOOP(i)
+		{
+			sum += (~w[i*ArrayStride( v)]) & 0xffffffffLL;
+			lanes[i*BF_LANES + l] = sum & 0xffffffffLL;
+			sum >>= 32;
+		}
+	}
+	return signs;
+}
+
+/*  c = a + b value by value.  returns 0 if counts differ.
+	any can be the same.
+*/
+
+int bf_array_add( BFARRAY a, BFARRAY b, BFARRAY c)
+{
+	FLOAT	x, y;
+	int		i;
+
+	if( (a.count != b.count) || (a.count != c.count)) return 0;
+	for( i=0; i<a.count; i++)
+	{
+		bf_array_load( a, i, &x);
+		bf_array_load( b, i, &y);
+		bf_add( &x, &y, &x);
+		bf_array_store( c, i, &x);
+	}
+	return 1;
+}
+
+/*  c = a*b value by value, or c = a*b + c if addflag.  Results same
+	as bf_multiply (and bf_add).  returns 0 if counts differ.
+	any can be the same.
+*/
+
+static int array_mul( BFARRAY a, BFARRAY b, BFARRAY c, int addflag)
+{
+	ELEMENT	al[MNTSA_SIZE*BF_LANES], bl[MNTSA_SIZE*BF_LANES];
+	ELEMENT	cl[MNTSA_SIZE*BF_LANES];
+	long	expnt[BF_LANES];
+	FLOAT	r, t;
+	int		i, l, m, signs, limbs;
+
+	if( (a.count != b.count) || (a.count != c.count)) return 0;
+	limbs = lane_limbs();
+	for( i=0; i<a.count; i+=BF_LANES)
+	{
+		m = (a.count - i < BF_LANES) ? a.count - i : BF_LANES;
+		signs = array_to_lanes( a, i, m, al) ^ array_to_lanes( b, i, m, bl);
+		for( l=0; l<m; l++)
+			expnt[l] = ArrayExpnt( a)[i + l] + ArrayExpnt( b)[i + l] + 1;
+		mul_lanes( al, bl, limbs, cl);
+		for( l=0; l<m; l++)
+		{
+			from_lanes( cl, l, expnt[l], (signs >> l) & 1, &r);
+			if( addflag)
+			{
+				bf_array_load( c, i + l, &t);
+				bf_add( &r, &t, &r);
+			}
+			bf_array_store( c, i + l, &r);
+		}
+	}
+	return 1;
+}
+
+int bf_array_mul( BFARRAY a, BFARRAY b, BFARRAY c)
+{
+	return array_mul( a, b, c, 0);
+}
+
+int bf_array_fma( BFARRAY a, BFARRAY b, BFARRAY c)
+{
+	return array_mul( a, b, c, 1);
+}
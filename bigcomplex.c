@@ -4,7 +4,9 @@
 
 #include <stdio.h>
 #include "bigfloat.h"
+#include "multipoly.h"
 
+extern RAMDATA ram_block[];
 
 /*  set a float to a constant 1  */
 
@@ -25,16 +27,13 @@ void bf_null_cmplx( COMPLEX *x)
 
 /*  add two complex numbers.
 	c = a + b 
+	bf_add takes any aliasing and each part only meets the same
+	part, so nothing is copied.
 */
 void bf_add_cmplx( COMPLEX *a, COMPLEX *b, COMPLEX *c)
 {
-	COMPLEX mya, myb;
-
-	bf_copy_cmplx( a, &mya);
-	bf_copy_cmplx( b, &myb);
-	
-	bf_add( &mya.real, &myb.real, &c->real);
-	bf_add( &mya.imag, &myb.imag, &c->imag);
+	bf_add( &a->real, &b->real, &c->real);
+	bf_add( &a->imag, &b->imag, &c->imag);
 }
 
 /*  subtract two complex numbers
@@ -42,31 +41,45 @@ void bf_add_cmplx( COMPLEX *a, COMPLEX *b, COMPLEX *c)
 */
 void bf_subtract_cmplx( COMPLEX *a, COMPLEX *b, COMPLEX *c)
 {
-	COMPLEX myb;
-
-	bf_copy_cmplx( b, &myb);
-	bf_negate( &myb.real);
-	bf_negate( &myb.imag);
-	bf_add_cmplx( a, &myb, c);
+	bf_subtract( &a->real, &b->real, &c->real);
+	bf_subtract( &a->imag, &b->imag, &c->imag);
 }
 
 /*  multiply two complex numbers.
 
 	c = (a.real * b.real - a.imag * b.imag) + i(a.imag * b.real + a.real * b.imag)
+
+	At MNTSA_SIZE of GAUSS_MNTSA and up, Gauss's trick trades one
+	multiply for three adds:
+		k1 = b.real*(a.real + a.imag)
+		k2 = a.real*(b.imag - b.real)
+		k3 = a.imag*(b.real + b.imag)
+	c = (k1 - k3) + i(k1 + k2).  Error is then relative to |a||b|
+	rather than to each part.  All products are done before c is
+	written, so c can be a or b.
 */
 void bf_multiply_cmplx(  COMPLEX *a, COMPLEX *b, COMPLEX *c)
 {
-	COMPLEX mya, myb;
-	FLOAT	temp1, temp2;
+	FLOAT	k1, k2, k3, k4;
 
-	bf_copy_cmplx( a, &mya);
-	bf_copy_cmplx( b, &myb);
-	bf_multiply( &mya.real, &myb.real, &temp1);
-	bf_multiply( &mya.imag, &myb.imag, &temp2);
-	bf_subtract( &temp1, &temp2, &c->real);
-	bf_multiply( &mya.real, &myb.imag, &temp1);
-	bf_multiply( &mya.imag, &myb.real, &temp2);
-	bf_add( &temp1, &temp2, &c->imag);
+	if( MNTSA_SIZE >= GAUSS_MNTSA)
+	{
+		bf_add( &a->real, &a->imag, &k1);
+		bf_multiply( &b->real, &k1, &k1);
+		bf_subtract( &b->imag, &b->real, &k2);
+		bf_multiply( &a->real, &k2, &k2);
+		bf_add( &b->real, &b->imag, &k3);
+		bf_multiply( &a->imag, &k3, &k3);
+		bf_subtract( &k1, &k3, &c->real);
+		bf_add( &k1, &k2, &c->imag);
+		return;
+	}
+	bf_multiply( &a->real, &b->real, &k1);
+	bf_multiply( &a->imag, &b->imag, &k2);
+	bf_multiply( &a->real, &b->imag, &k3);
+	bf_multiply( &a->imag, &b->real, &k4);
+	bf_subtract( &k1, &k2, &c->real);
+	bf_add( &k3, &k4, &c->imag);
 }
 
 /*  divide two complex numbers.
@@ -74,8 +87,10 @@ void bf_multiply_cmplx(  COMPLEX *a, COMPLEX *b, COMPLEX *c)
 	conjugate of bottom.  Scale result by magnitude of
 	bottom.
 	
-		output is c = ( a * b^*) / |b|
+		output is c = ( a * b^*) / |b|^2
 	
+	1/|b|^2 is found once and folded into b^* so there is one
+	reciprocal and no divides.
 	returns 1 if b != 0, 0 if |b| = 0
 */
 int bf_divide_cmplx( COMPLEX *a, COMPLEX *b, COMPLEX *c)
@@ -83,77 +98,154 @@ int bf_divide_cmplx( COMPLEX *a, COMPLEX *b, COMPLEX *c)
 	FLOAT	mag1, mag2;
 	COMPLEX	myb;
 	
-	bf_copy_cmplx( b, &myb);
-	bf_multiply( &myb.real, &myb.real, &mag1);
-	bf_multiply( &myb.imag, &myb.imag, &mag2);
+	bf_square( &b->real, &mag1);
+	bf_square( &b->imag, &mag2);
 	bf_add( &mag1, &mag2, &mag1);
+	if( !bf_reciprical( &mag1, &mag1)) return 0;
+	bf_multiply( &b->real, &mag1, &myb.real);
+	bf_multiply( &b->imag, &mag1, &myb.imag);
 	bf_negate( &myb.imag);
 	bf_multiply_cmplx( a, &myb, c);
-	if( ! bf_divide( &c->real, &mag1, &c->real)) return 0;
-	bf_divide( &c->imag, &mag1, &c->imag);
 	return 1;
 }
 
+/*  square a complex number.
+	c = (a.real^2 - a.imag^2) + i(2 * a.real * a.imag)
+	uses the real squaring kernel for two of the three products,
+	which is cheaper than (a.real + a.imag)*(a.real - a.imag).
+*/
+void bf_square_cmplx( COMPLEX *a, COMPLEX *c)
+{
+	FLOAT	temp1, temp2, cross;
+
+	bf_multiply( &a->real, &a->imag, &cross);
+	bf_square( &a->real, &temp1);
+	bf_square( &a->imag, &temp2);
+	bf_subtract( &temp1, &temp2, &c->real);
+	cross.expnt++;
+	bf_copy( &cross, &c->imag);
+}
+
 /*  compute y = x^k
 	where k is a signed integer in range +/-2^31 and x, y are complex.
+	Sliding window same as bf_intpwr, odd powers of x in a table and
+	one complex multiply per window instead of per set bit.
 	returns 1 if ok, 0 if x = 0 and k < 0
 */
 
 int bf_intpwr_cmplx( COMPLEX *x, int k, COMPLEX  *y)
 {
-	int signflag, n;
-	COMPLEX z, t;
-	
-/*	FLOAT seven, temp;
+	COMPLEX			odd[1 << (INTPWR_WINDOW - 1)], x2, t;
+	unsigned int	n, value;
+	int				i, l, w, nbits, started;
 	
-	null(&seven);
-	seven.expnt = 3;
-	seven.mntsa.e[MS_MNTSA] = 0x70000000;
-	square_root( &seven, &seven);
-	
-/*  initialize Knuth's algorithm A pg 442 semi-numerical algorithms  */
-
-	bf_copy_cmplx( x, &z);
-	if ( k < 0 )
+	n = (k < 0) ? -(unsigned int)k : (unsigned int)k;
+	if( !n)
 	{
-		signflag = 1;
-		n = -k;
+		bf_null_cmplx( y);
+		bf_one( &y->real);
+		return 1;
 	}
-	else
+	nbits = 0;
+	while( (nbits < 32) && (n >> nbits)) nbits++;
+	w = bf_window_bits( nbits);
+	bf_copy_cmplx( x, &odd[0]);
+	if( w > 1)
 	{
-		signflag = 0;
-		n = k;
+		bf_square_cmplx( x, &x2);
+		for( i=1; i < (1 << (w - 1)); i++)
+			bf_multiply_cmplx( &odd[i-1], &x2, &odd[i]);
 	}
-	bf_null_cmplx( &t);
-	bf_one( &t.real);
-	while (n)
+	started = 0;
+	i = nbits - 1;
+	while( i >= 0)
 	{
-		if ( n & 1 ) bf_multiply_cmplx( &t, &z, &t);
-		bf_multiply_cmplx( &z, &z, &z);
-		n >>= 1;
+		if( !((n >> i) & 1))
+		{
+			bf_square_cmplx( &t, &t);
+			i--;
+			continue;
+		}
+		l = i - w + 1;
+		if( l < 0) l = 0;
+		while( !((n >> l) & 1)) l++;
+		value = (n >> l) & ((1U << (i - l + 1)) - 1);
+		if( started)
+		{
+			for( ; i >= l; i--) bf_square_cmplx( &t, &t);
+			bf_multiply_cmplx( &t, &odd[value >> 1], &t);
+		}
+		else
+		{
+			bf_copy_cmplx( &odd[value >> 1], &t);
+			started = 1;
+		}
+		i = l - 1;
 	}
-	if ( signflag)
+	if ( k < 0)
 	{
-		bf_null_cmplx( &z);
-		bf_one( &z.real);
-		return bf_divide_cmplx( &z, &t, y);
+		bf_null_cmplx( &x2);
+		bf_one( &x2.real);
+		return bf_divide_cmplx( &x2, &t, y);
 	}
 	bf_copy_cmplx( &t, y);
 	return 1;
 }
 
+/*  evaluate polynomial with real coefficients at complex x.
+	Input:  MULTIPOLY coefficients, pointer to x, pointer to y
+	Output:  y = F(x)
+	Horner's rule, so each coefficient costs one real add into the
+	real part and one complex multiply.  y can equal x.
+*/
+
+void bf_polyeval_cmplx( MULTIPOLY coef, COMPLEX *x, COMPLEX *y)
+{
+	INDEX	i;
+	COMPLEX	sum;
+	FLOAT	*cof;
+
+	cof = Address( coef) + coef.degree;
+	bf_copy( cof, &sum.real);
+	bf_null( &sum.imag);
+	for( i=coef.degree-1; i>=0; i--)
+	{
+		bf_multiply_cmplx( x, &sum, &sum);
+		cof = Address( coef) + i;
+		bf_add( cof, &sum.real, &sum.real);
+	}
+	bf_copy_cmplx( &sum, y);
+}
+
+/*  compute |x|^2 of a complex number, no square root.
+	Good for comparing magnitudes.
+*/
+
+void bf_abs2_cmplx( COMPLEX *x, FLOAT *m)
+{
+	FLOAT	y2;
+
+	bf_square( &x->imag, &y2);
+	bf_square( &x->real, m);
+	bf_add( m, &y2, m);
+}
+
 /*  compute magnitude of a complex number.  Returns
 	FLOAT result.
 */
 
 void bf_magnitude_cmplx( COMPLEX *x, FLOAT *m)
 {
-	FLOAT x2, y2;
-	
-	bf_multiply( &x->real, &x->real, &x2);
-	bf_multiply( &x->imag, &x->imag, &y2);
-	bf_add( &x2, &y2, m);
-	bf_square_root( m, m);
+	bf_hypot( &x->real, &x->imag, m);
+}
+
+/*  compute argument of a complex number, -PI < a <= PI.
+	returns 0 if x = 0 (a is 0), 1 otherwise.
+*/
+
+int bf_arg_cmplx( COMPLEX *x, FLOAT *a)
+{
+	return bf_atan2( &x->imag, &x->real, a);
 }
 
 /*  compute exp(z) for z complex.
@@ -175,12 +267,113 @@ int bf_exp_cmplx( COMPLEX *z, COMPLEX *e)
 		bf_null( &e->imag);
 		return 0;
 	}
-	bf_cosine( &y, &cy);
+	bf_sincos( &y, &sy, &cy);
 //	printfloat("cos(y)=", &cy);
-	bf_sine( &y, &sy);
 //	printfloat("sin(y)=", &sy);
 	bf_multiply( &xp, &cy, &e->real);
 //	printfloat("exp(x)=", &xp);
 	bf_multiply( &xp, &sy, &e->imag);
 	return 1;
 }
+
+/*  compute w = log(z) for z complex, principal branch.
+	log(z) = log|z| + i*arg(z), and log|z| = log(|z|^2)/2 so no
+	square root is needed.
+	returns 0 if z = 0, 1 otherwise.  works in place.
+*/
+
+int bf_log_cmplx( COMPLEX *z, COMPLEX *w)
+{
+	FLOAT	m, a, u, t;
+
+	if( !bf_arg_cmplx( z, &a)) return 0;
+	bf_abs2_cmplx( z, &m);
+
+/*  for 1/2 <= |z|^2 < 2 log(|z|^2) cancels, take log1p of
+	|z|^2 - 1 = (x - 1)*(x + 1) + y^2 instead, which keeps the low bits
+*/
+	if( (m.expnt == 0) || (m.expnt == 1))
+	{
+		bf_one( &t);
+		bf_subtract( &z->real, &t, &u);
+		bf_add( &z->real, &t, &t);
+		bf_multiply( &u, &t, &u);
+		bf_square( &z->imag, &t);
+		bf_add( &u, &t, &u);
+		bf_log1p( &u, &m);
+	}
+	else bf_log( &m, &m);
+	if( !bf_iszero( &m)) m.expnt--;
+	bf_copy( &m, &w->real);
+	bf_copy( &a, &w->imag);
+	return 1;
+}
+
+/*  compute w = sqrt(z) for z complex, principal branch so
+	w.real >= 0.  With r = |z| and t = sqrt((r + |x|)/2)
+
+		x >= 0:  w = t + i*y/(2t)
+		x < 0:   w = |y|/(2t) + i*sign(y)*t
+
+	so nothing cancels.  t and 1/t both come from one bf_rsqrt.
+	works in place.
+*/
+
+void bf_sqrt_cmplx( COMPLEX *z, COMPLEX *w)
+{
+	FLOAT	x, y, s, u, t;
+
+	bf_copy( &z->real, &x);
+	bf_copy( &z->imag, &y);
+	if( bf_iszero( &x) && bf_iszero( &y))
+	{
+		bf_null_cmplx( w);
+		return;
+	}
+	bf_hypot( &x, &y, &s);
+	if( x.mntsa.e[MS_MNTSA] & SIGN_BIT) bf_subtract( &s, &x, &s);
+	else bf_add( &s, &x, &s);
+	s.expnt--;
+	bf_rsqrt( &s, &u);
+	bf_multiply( &s, &u, &t);
+	bf_multiply( &y, &u, &u);
+	if( !bf_iszero( &u)) u.expnt--;
+	if( x.mntsa.e[MS_MNTSA] & SIGN_BIT)
+	{
+		if( u.mntsa.e[MS_MNTSA] & SIGN_BIT)
+		{
+			bf_negate( &u);
+			bf_negate( &t);
+		}
+		bf_copy( &u, &w->real);
+		bf_copy( &t, &w->imag);
+	}
+	else
+	{
+		bf_copy( &t, &w->real);
+		bf_copy( &u, &w->imag);
+	}
+}
+
+/*  compute w = z^p for z and p complex, principal branch.
+	z^p = exp(p*log(z)), log|z| and arg(z) are found once and the
+	exp of the product gives both parts from one exp and one sincos.
+	0^p is 0 if p.real > 0.
+	returns 0 if z = 0 and p.real <= 0 or the result overflows,
+	1 otherwise.  works in place.
+*/
+
+int bf_pow_cmplx( COMPLEX *z, COMPLEX *p, COMPLEX *w)
+{
+	COMPLEX	lz;
+
+	if( !bf_log_cmplx( z, &lz))
+	{
+		if( bf_iszero( &p->real) || (p->real.mntsa.e[MS_MNTSA] & SIGN_BIT))
+			return 0;
+		bf_null_cmplx( w);
+		return 1;
+	}
+	bf_multiply_cmplx( p, &lz, &lz);
+	return bf_exp_cmplx( &lz, w);
+}
@@ -0,0 +1,171 @@
+/*  Lazy expression graphs.  A formula is built once as a DAG of nodes,
+	each one a constant or a bf_ball operation on earlier nodes.  Asking
+	for the root to some number of bits only evaluates each node as far
+	as its parent needs, and every node keeps its last ball and how many
+	bits it certifies.  The balls carry proved error bounds, see
+	bigball.c, so certified bits are guaranteed, not estimated.  Asking
+	again for more bits only redoes nodes that were too short.  Nodes
+	are kept in a fixed table like ram_block and referred to by index,
+	so sharing a subexpression is just using its index twice.
+*/
+
+#include <stdio.h>
+#include "bigfloat.h"
+#include "multipoly.h"
+
+extern int bf_work_limbs;
+
+#define	DAG_MAXNODES	1024
+#define	DAG_LOOPS		8
+#define	DAG_GUARD		8
+
+typedef struct
+{
+	int		op;
+	int		a, b;		/*  operand node indices, -1 if not used  */
+	int		bits;		/*  bits certified by val, -1 if never evaluated  */
+	BALL	val;
+} DAGNODE;
+
+static DAGNODE	dag_node[DAG_MAXNODES];
+static int		dag_count = 0;
+
+/*  throw away all nodes  */
+
+void bf_dag_clear( void)
+{
+	dag_count = 0;
+}
+
+/*  constant node with exact value x.  returns index or -1 if full.  */
+
+int bf_dag_const( FLOAT *x)
+{
+	DAGNODE	*n;
+
+	if( dag_count >= DAG_MAXNODES) return -1;
+	n = &dag_node[dag_count];
+	n->op = DAG_CONST;
+	n->a = -1;
+	n->b = -1;
+	bf_ball_set( x, &n->val);
+	n->bits = 32*MNTSA_SIZE - 2;
+	return dag_count++;
+}
+
+/*  node for op on a (and b for binary ops).  Operands must already
+	exist.  returns index or -1 if full or an operand is bad.
+*/
+
+int bf_dag_op( int op, int a, int b)
+{
+	DAGNODE	*n;
+
+	if( dag_count >= DAG_MAXNODES) return -1;
+	if( (a < 0) || (a >= dag_count)) return -1;
+	if( (op <= DAG_DIV) && ((b < 0) || (b >= dag_count))) return -1;
+	if( (op < DAG_ADD) || (op > DAG_SIN)) return -1;
+	n = &dag_node[dag_count];
+	n->op = op;
+	n->a = a;
+	n->b = (op <= DAG_DIV) ? b : -1;
+	n->bits = -1;
+	bf_null( &n->val.mid);
+	bf_null( &n->val.rad);
+	return dag_count++;
+}
+
+/*  mantissa words needed for bits  */
+
+static int dag_limbs( int bits)
+{
+	int		limbs;
+
+	limbs = (bits + 31)/32 + 1;
+	if( limbs < 2) limbs = 2;
+	if( limbs > MNTSA_SIZE) limbs = MNTSA_SIZE;
+	return limbs;
+}
+
+/*  do one node's operation on its operands' current balls.
+	returns 0 if the operation was not possible.
+*/
+
+static int dag_apply( DAGNODE *n, BALL *y)
+{
+	BALL	*a, *b;
+
+	a = &dag_node[n->a].val;
+	b = (n->b >= 0) ? &dag_node[n->b].val : 0;
+	switch( n->op)
+	{
+		case DAG_ADD:	bf_ball_add( a, b, y);			return 1;
+		case DAG_SUB:	bf_ball_subtract( a, b, y);		return 1;
+		case DAG_MUL:	bf_ball_multiply( a, b, y);		return 1;
+		case DAG_DIV:	return bf_ball_divide( a, b, y);
+		case DAG_SQRT:	return bf_ball_sqrt( a, y);
+		case DAG_EXP:	return bf_ball_exp( a, y);
+		case DAG_COS:	bf_ball_cosine( a, y);			return 1;
+		case DAG_SIN:	bf_ball_sine( a, y);			return 1;
+	}
+	return 0;
+}
+
+/*  bring node k up to bits certified bits.  Operands are asked for
+	DAG_GUARD more, and if cancellation or a steep function still
+	leaves the node short, the shortfall is added to what they are
+	asked for and it goes again.  Cancellation across very different
+	exponents can leave nothing at all, so what is asked for at least
+	doubles each time and full length is reached within DAG_LOOPS.
+	returns 1 if bits reached, 0 if full precision could not get there.
+*/
+
+static int dag_eval( int k, int bits)
+{
+	DAGNODE	*n;
+	BALL	y;
+	int		want, step, loop, save, ok, got;
+
+	n = &dag_node[k];
+	if( n->bits >= bits) return 1;
+	if( n->op == DAG_CONST) return 0;
+	want = bits + DAG_GUARD;
+	for( loop=0; loop<DAG_LOOPS; loop++)
+	{
+		if( want > 32*MNTSA_SIZE - 2) want = 32*MNTSA_SIZE - 2;
+		dag_eval( n->a, want);
+		if( n->b >= 0) dag_eval( n->b, want);
+		save = bf_work_limbs;
+		bf_work_limbs = dag_limbs( want);
+		ok = dag_apply( n, &y);
+		bf_work_limbs = save;
+		got = ok ? bf_ball_bits( &y) : 0;
+		if( ok && (got > n->bits))
+		{
+			bf_ball_copy( &y, &n->val);
+			n->bits = got;
+		}
+		if( got >= bits) return 1;
+		if( want >= 32*MNTSA_SIZE - 2) return 0;
+		step = bits - got + DAG_GUARD;
+		if( step < want) step = want;
+		want += step;
+	}
+	return 0;
+}
+
+/*  evaluate node k to bits good bits, y gets the midpoint.
+	Earlier results are reused and only refined as needed.
+	returns 1 if bits were certified, 0 if not (y is then the best
+	value found, the node may be zero or need more than MNTSA_SIZE).
+*/
+
+int bf_dag_eval( int k, int bits, FLOAT *y)
+{
+	int		ok;
+
+	if( (k < 0) || (k >= dag_count)) return 0;
+	ok = dag_eval( k, bits);
+	bf_copy( &dag_node[k].val.mid, y);
+	return ok;
+}
@@ -14,11 +14,211 @@
 #include "bigfloat.h"
 #include "multipoly.h"
 
-extern MULTIPOLY	twoxcoef;
-extern MULTIPOLY	coscoef;
+extern CHEBSERIES	twoxcoef;
+extern CHEBSERIES	coscoef;
 extern FLOAT		P2;
 extern FLOAT		ln2;
 
+/*  number of most significant mantissa words multiplies and Newton
+	iterations work on.  Reduced accuracy functions in bigfunc.c
+	lower this and put it back.
+*/
+
+int		bf_work_limbs = MNTSA_SIZE;
+
+/*  Mantissa word kernels.  Add, normalize, multiply and square do
+	their word loops here.  Words are 32 bits held in ELEMENTs, least
+	significant first.
+*/
+
+/*  lowest nonzero word of x at or above word low, MNTSA_SIZE if
+	none.  Small integers and short fractions have zero low words,
+	the loops below start here instead of finding them one product
+	at a time.
+*/
+
+static int lowword( ELEMENT *x, int low)
+{
+	while( (low < MNTSA_SIZE) && !x[low]) low++;
+	return low;
+}
+
+/*  c = a + b over all MNTSA_SIZE words.  returns carry out of the
+	top word.  c can be a or b.
+*/
+
+static ELEMENT mntsa_add( ELEMENT *a, ELEMENT *b, ELEMENT *c)
+{
+	unsigned long long	sum;
+	int		i;
+
+/*  low words zero in both stay zero with no carry  */
+
+	for( i=0; (i < MS_MNTSA) && !(a[i] | b[i]); i++) c[i] = 0;
+	sum = 0;
+	for( ; i<MNTSA_SIZE; i++)
+	{
+		sum += (unsigned long long)a[i] + (unsigned long long)b[i];
+		c[i] = sum & 0xffffffffLL;
+		sum >>= 32;
+	}
+	return sum;
+}
+
+/*  c = a*b, unsigned, top limbs words of each.  Lowest column keeps
+	only the high halves of its products, each column above is summed
+	exactly with low and high halves apart, so there is no carry
+	inside the inner loop.  Words of c below the top limbs are zero.
+	Products with a zero low word of a or b are skipped, a times a
+	one word integer costs one pass.  c must not be a or b.
+*/
+
+static void mntsa_mul( ELEMENT *a, ELEMENT *b, int limbs, ELEMENT *c)
+{
+	ELEMENT	br[MNTSA_SIZE];
+	unsigned long long	lo, hi, hiprev, carry, p;
+	int		j, t, low, la, lb, jlo, jhi;
+
+	low = MNTSA_SIZE - limbs;
+	la = lowword( a, low);
+	lb = lowword( b, low);
+	OPLOOP(j) br[j] = b[MS_MNTSA - j];
+	for( t=0; t<low; t++) c[t] = 0;
+	hiprev = 0;
+	for( j=la; j<=MS_MNTSA + low - lb; j++)
+		hiprev += ((unsigned long long)a[j] *
+				(unsigned long long)br[j - low]) >> 32;
+
+/*  word t gets low halves of column t and high halves of column t-1  */
+
+	carry = 0;
+	for( t=low; t<MNTSA_SIZE; t++)
+	{
+		lo = 0;
+		hi = 0;
+		jlo = (t + 1 > la) ? t + 1 : la;
+		jhi = (t + MNTSA_SIZE - lb < MS_MNTSA) ? t + MNTSA_SIZE - lb : MS_MNTSA;
+		for( j=jlo; j<=jhi; j++)
+		{
+			p = (unsigned long long)a[j] *
+				(unsigned long long)br[j - t - 1];
+			lo += p & 0xffffffffLL;
+			hi += p >> 32;
+		}
+		carry += lo + hiprev;
+		c[t] = carry & 0xffffffffLL;
+		carry >>= 32;
+		hiprev = hi;
+	}
+}
+
+/*  c = a^2, unsigned, same truncation as mul.  Each cross product
+	is found once and doubled, summed a column at a time in a 96 bit
+	accumulator.  Zero low words are skipped same as mul.  c must
+	not be a.
+*/
+
+static void mntsa_sqr( ELEMENT *a, int limbs, ELEMENT *c)
+{
+	unsigned long long	mult, acc, acchi;
+	int		i, j, k, lo, la;
+
+	lo = MNTSA_SIZE - limbs;
+	la = lowword( a, lo);
+	for( i=0; i<lo; i++) c[i] = 0;
+
+/*  first column only contributes its high halves, round down  */
+
+	acc = 0;
+	acchi = 0;
+	for( j=la; j<MNTSA_SIZE; j++)
+	{
+		k = MS_MNTSA + lo - j;
+		if( (k < j) || (k < la)) break;
+		mult = ( (unsigned long long)a[j] *
+				(unsigned long long)a[k] ) >> 32;
+		acc += mult;
+		if( k != j) acc += mult;
+	}
+
+/*  column MS_MNTSA + i + 1 lands low half in word i  */
+
+	for( i=lo; i<MNTSA_SIZE; i++)
+	{
+		for( j=(i + 1 > la) ? i + 1 : la; j<MNTSA_SIZE; j++)
+		{
+			k = MS_MNTSA + i + 1 - j;
+			if( (k < j) || (k < la)) break;
+			mult = (unsigned long long)a[j] *
+					(unsigned long long)a[k];
+			acc += mult;
+			if( acc < mult) acchi++;
+			if( k != j)
+			{
+				acc += mult;
+				if( acc < mult) acchi++;
+			}
+		}
+		c[i] = acc & 0xffffffffLL;
+		acc = (acc >> 32) | (acchi << 32);
+		acchi >>= 32;
+	}
+}
+
+/*  shift x right by bits, 0 <= bits, filling from the top with fill
+	(0 or ~0).  Whole words move first, then each word is a funnel
+	shift of itself and the word above.
+*/
+
+static void mntsa_rshift( ELEMENT *x, int bits, ELEMENT fill)
+{
+	int		i, words;
+
+	fill &= 0xffffffffLL;
+	words = bits >> 5;
+	bits &= 31;
+	if( words >= MNTSA_SIZE)
+	{
+		OPLOOP(i) x[i] = fill;
+		return;
+	}
+	if( words)
+	{
+		for( i=0; i<MNTSA_SIZE - words; i++) x[i] = x[i + words];
+		for( ; i<MNTSA_SIZE; i++) x[i] = fill;
+	}
+	if( !bits) return;
+	for( i=0; i<MS_MNTSA; i++)
+		x[i] = ( ( ((unsigned long long)x[i+1] << 32) | x[i]) >> bits)
+				& 0xffffffffLL;
+	x[MS_MNTSA] = ( ( ((unsigned long long)fill << 32) | x[MS_MNTSA]) >> bits)
+				& 0xffffffffLL;
+}
+
+/*  shift x left by bits, 0 <= bits, zeros in from the bottom  */
+
+static void mntsa_lshift( ELEMENT *x, int bits)
+{
+	int		i, words;
+
+	words = bits >> 5;
+	bits &= 31;
+	if( words >= MNTSA_SIZE)
+	{
+		OPLOOP(i) x[i] = 0;
+		return;
+	}
+	if( words)
+	{
+		for( i=MS_MNTSA; i>=words; i--) x[i] = x[i - words];
+		for( ; i>=0; i--) x[i] = 0;
+	}
+	if( !bits) return;
+	for( i=MS_MNTSA; i>0; i--)
+		x[i] = ( ( ((unsigned long long)x[i] << 32) | x[i-1]) << bits) >> 32
+				& 0xffffffffLL;
+	x[0] = ((unsigned long long)x[0] << bits) & 0xffffffffLL;
+}
 
 /*  copy a floating point value from a to b  */
 
@@ -67,84 +267,86 @@ void bf_negate( FLOAT *a)
 	}
 }
 
+/*  bit number of the most significant 1 in a 32 bit word, w != 0.
+	gcc has count leading zeros, otherwise the same trick as in
+	"degreeof" subroutine.
+*/
+
+static int word_msb( ELEMENT w)
+{
+#ifdef __GNUC__
+	return 63 - __builtin_clzll( (unsigned long long)w);
+#else
+	int		i, bit;
+	ELEMENT	mask;
+
+	bit = 0;
+	mask = 0xffffffff;
+	for( i=16; i>0; i >>= 1)
+	{
+		mask ^= mask >> i;
+		if( mask & w)
+		{
+			bit += i;
+			w &= mask;
+		}
+	}
+	return bit;
+#endif
+}
+
+/*  bit number of the most significant 1 of the mantissa taken as an
+	unsigned 32*MNTSA_SIZE bit integer, -1 if it is all zero.
+*/
+
+int bf_topbit( FLOAT *x)
+{
+	int		i;
+
+	for( i=MS_MNTSA; i>=0; i--)
+		if( x->mntsa.e[i]) return 32*i + word_msb( x->mntsa.e[i]);
+	return -1;
+}
+
+/*  shift mantissa of x up by bits, or down by -bits with fill (0 or
+	~0) coming in at the top.  Exponent is not touched.  Normalize,
+	add alignment and the integer part routines all move bits with
+	this, whole words then one funnel shift per word.
+*/
+
+void bf_shift_mntsa( FLOAT *x, int bits, ELEMENT fill)
+{
+	if( bits > 0) mntsa_lshift( x->mntsa.e, bits);
+	else if( bits < 0) mntsa_rshift( x->mntsa.e, -bits, fill);
+}
+
 /*  normalize a floating point number.  Called at the end of add and multiply
 	(and divide?),  it shifts results up till sign bit clear and next bit set.
 	binary point sits after sign bit, so all fractions are in range 1/4 to 1/2.
 	exponent has +/- 2^31 range, on underflow or overflow of exponent
 	you ought to flag an error.
+	One shift of the magnitude does it, down 1 bit if negating set the
+	sign bit, otherwise up to put the top 1 at bit 30 of the top word.
 */
 void bf_normal(  FLOAT *x)
 {
-	int	i, j, signflag, upshift, downshift;
-	long	xpnt;
-	unsigned long mask, uprmask, msb, temp;
+	int	signflag, upshift, top;
 	
 	signflag = 0;
-	xpnt = x->expnt;
 	if( x->mntsa.e[MS_MNTSA] & SIGN_BIT)
 	{
 		bf_negate(x);
 		signflag = 1;
 	}
-	for( i=MS_MNTSA; i>=0; i--)  if ( x->mntsa.e[i]) break;
-	if ( i<0 )
+	top = bf_topbit( x);
+	if ( top < 0 )
 	{
 		x->expnt = 0;  //  result is zero
 		return;
 	}
-	if ( i != MS_MNTSA) 
-	{
-		xpnt -= 32*(MS_MNTSA - i);
-		for ( j=MS_MNTSA; i >= 0; i--)
-		{
-			x->mntsa.e[j] = x->mntsa.e[i];
-			x->mntsa.e[i] = 0;
-			j--;
-		}
-	}
-	
-/*  find most significant bit.  Same trick as in "degreeof" subroutine  */
-
-	msb = x->mntsa.e[MS_MNTSA];
-	downshift = 0;
-	mask = ~0;
-	for( i=16; i>0; i >>= 1)
-	{
-		mask ^= mask >> i;
-		if ( mask & msb)
-		{
-			downshift += i;
-			msb &= mask;
-		}
-	}
-	if ( downshift == 31 ) // then right shift 1 bit
-	{
-		for (i=0; i<MS_MNTSA; i++)
-		{
-			msb = (x->mntsa.e[i+1] & 1) ? SIGN_BIT : 0;
-			x->mntsa.e[i] = ( x->mntsa.e[i] >> 1) | msb;
-		}
-		x->mntsa.e[MS_MNTSA] >>= 1;
-		x->expnt = xpnt + 1;
-		goto	normlrtn;
-	}
-	if ( downshift == 30 ) goto normlrtn;
-	upshift = 30 - downshift;
-	downshift += 2;
-	x->mntsa.e[MS_MNTSA] <<= upshift;
-	uprmask = ~0 << downshift;
-	mask = ~uprmask;
-	for( i=MS_MNTSA; i>0; i--)
-	{
-		x->mntsa.e[i] |= (x->mntsa.e[i-1] & uprmask) >> downshift;
-		x->mntsa.e[i-1] = (x->mntsa.e[i-1] & mask) << upshift;
-	}
-
-/*  check if input was negative and return  corrected exponent  */
-
-	xpnt -= upshift;
-normlrtn:
-	x->expnt = xpnt;
+	upshift = 32*MS_MNTSA + 30 - top;
+	bf_shift_mntsa( x, upshift, 0);
+	x->expnt -= upshift;
 	if (signflag) bf_negate (x);
 }
 
@@ -153,12 +355,16 @@ normlrtn:
 		+1 if |a| > |b|
 		-1 if |a| < |b|
 		  0 if |a| = |b|
+	Nothing is copied.  With the same sign the words compare
+	directly, with opposite signs the sign of a + b says which is
+	bigger and the sum can't overflow.
 */
 
 int bf_compare( FLOAT *a, FLOAT *b)
 {
-	FLOAT mya, myb;
-	int i;
+	unsigned long long	sum;
+	ELEMENT	nonzero;
+	int i, aneg;
 	
 /*  first compare exponents, takes care of most cases  */
 
@@ -167,35 +373,47 @@ int bf_compare( FLOAT *a, FLOAT *b)
 
 /*  exponents match, check mantissas  */
 
-	bf_copy( a, &mya);
-	bf_copy( b, &myb);
-	if( mya.mntsa.e[MS_MNTSA] & SIGN_BIT)
-		bf_negate( &mya);
-	if( myb.mntsa.e[MS_MNTSA] & SIGN_BIT)
-		bf_negate( &myb);
-	for( i=MS_MNTSA; i >= 0; i--)
+	aneg = (a->mntsa.e[MS_MNTSA] & SIGN_BIT) ? 1 : 0;
+	if( !((a->mntsa.e[MS_MNTSA] ^ b->mntsa.e[MS_MNTSA]) & SIGN_BIT))
 	{
-		if( mya.mntsa.e[i] > myb.mntsa.e[i]) return 1;
-		if( mya.mntsa.e[i] < myb.mntsa.e[i]) return -1;
+		for( i=MS_MNTSA; i >= 0; i--)
+		{
+			if( a->mntsa.e[i] > b->mntsa.e[i]) return aneg ? -1 : 1;
+			if( a->mntsa.e[i] < b->mntsa.e[i]) return aneg ? 1 : -1;
+		}
+		return 0;
 	}
-	return 0;
+	sum = 0;
+	nonzero = 0;
+	OPLOOP(i)
+	{
+		sum += (unsigned long long)a->mntsa.e[i] + (unsigned long long)b->mntsa.e[i];
+		nonzero |= sum & 0xffffffffLL;
+		if( i < MS_MNTSA) sum >>= 32;
+	}
+	if( !nonzero) return 0;
+	if( (sum & SIGN_BIT) ? !aneg : aneg) return -1;
+	return 1;
 }
 
-/*  add two floating point numbers a + b = c.
-	Makes local copies of data, so any pointers can be the same.
+/*  c = a + b, or a - b if negb.  Only the smaller operand is copied,
+	to be shifted into line, and the bigger one too if it has to be
+	negated.  The sum goes straight into c since the add kernel works
+	in place, so any pointers can be the same.
 */
-void bf_add( FLOAT *a, FLOAT *b, FLOAT *c)
+
+static void add_core( FLOAT *a, FLOAT *b, int negb, FLOAT *c)
 {
-	FLOAT big, small, result;
-	int	i, uper, lower, bigsign, resultsign, smallsign;
-	unsigned long	msb, himask, lomask;
-	unsigned long long carry, temp, carrycheck;
+	FLOAT	*big, small, negbig;
+	int	i, bigsign, resultsign, smallsign;
+	ELEMENT	carry;
 
 /*  eliminate work if either input is zero  */
 
 	if (bf_iszero (a)) 
 	{
 		bf_copy (b, c);
+		if( negb) bf_negate( c);
 		return;
 	}
 	if (bf_iszero( b))
@@ -204,13 +422,14 @@ void bf_add( FLOAT *a, FLOAT *b, FLOAT *c)
 		return;
 	}
 	
-/* easy to deal with one big and one small, so copy accordingly 
+/* easy to deal with one big and one small, so point accordingly 
 	but equal magnitude and opposite signs causes problems */
 
 	i = bf_compare( a, b);
 	if( i == 0)		/*  a = b, very special case  */
 	{
-		if( a->mntsa.e[MS_MNTSA] ^ b->mntsa.e[MS_MNTSA])
+		if( ((a->mntsa.e[MS_MNTSA] ^ b->mntsa.e[MS_MNTSA]) & SIGN_BIT) ?
+				!negb : negb)
 		{
 			bf_null( c);
 			return;
@@ -221,69 +440,38 @@ void bf_add( FLOAT *a, FLOAT *b, FLOAT *c)
 	}
 	if (i > 0)
 	{
-		bf_copy( a, &big);
+		big = a;
 		bf_copy( b, &small);
+		if( negb) bf_negate( &small);
 	}
 	else
 	{
-		bf_copy( b, &big);
+		big = b;
+		if( negb)
+		{
+			bf_copy( b, &negbig);
+			bf_negate( &negbig);
+			big = &negbig;
+		}
 		bf_copy( a, &small);
 	}
- 	if ( (big.expnt - small.expnt) >= (32*MNTSA_SIZE) )
+ 	if ( (big->expnt - small.expnt) >= (32*MNTSA_SIZE) )
 	{
-		bf_copy( &big, c);
+		bf_copy( big, c);
 		return;
 	}
-	bigsign = big.mntsa.e[MS_MNTSA] & SIGN_BIT ? 1 : 0;
+	bigsign = big->mntsa.e[MS_MNTSA] & SIGN_BIT ? 1 : 0;
 	smallsign = small.mntsa.e[MS_MNTSA] & SIGN_BIT ? 1 : 0;
 	
-/*  unnormalize small number to align bits, big chunks first  */
+/*  unnormalize small number to align bits, sign fills from the top  */
 
-	while( (big.expnt - small.expnt) > 31)
-	{
-		for( i=0; i<MS_MNTSA; i++)
-			small.mntsa.e[i] = small.mntsa.e[i+1];
-		small.expnt += 32;
-		if ( small.mntsa.e[MS_MNTSA] & SIGN_BIT)
-			small.mntsa.e[MS_MNTSA] = ~0;
-		else
-			small.mntsa.e[MS_MNTSA] = 0;
-	}
-
-/*  Now move chunks down to finish alignment  */
-			
-	if( big.expnt > small.expnt)
-	{
-		uper = big.expnt - small.expnt;
-		lower = 32 - uper;
-		himask = ~0 << uper;
-		lomask = ~himask;
-		for( i=0; i<MS_MNTSA; i++)
-			small.mntsa.e[i] = (( small.mntsa.e[i] & himask) >> uper) |
-							(( small.mntsa.e[i+1] & lomask) << lower)
-		;
-		msb = ( small.mntsa.e[MS_MNTSA]  & himask) >> uper;
-		if ( small.mntsa.e[MS_MNTSA] & SIGN_BIT)
-			msb |= ( ~0 << (31 - uper));
-		else
-			msb &= ( ~0 >> (uper + 1));
-		small.mntsa.e[MS_MNTSA] = msb;
-	}
+	bf_shift_mntsa( &small, small.expnt - big->expnt, smallsign ? ~0 : 0);
 
 /*  mantissas aligned, add everything up.  Propagate carry too.  */
 
-	carry = 0;
-	carrycheck = (unsigned long long)SIGN_BIT << 1;
-	OPLOOP(i)
-	{
-		temp = (unsigned long long)big.mntsa.e[i] +
-				 (unsigned long long)small.mntsa.e[i] + carry;
-		if (temp & carrycheck ) carry = 1;
-		else carry = 0;
-		result.mntsa.e[i] = temp & 0xffffffff;
-	}
-	result.expnt = big.expnt;
-	resultsign = result.mntsa.e[MS_MNTSA] & SIGN_BIT ? 1 : 0;
+	c->expnt = big->expnt;
+	carry = mntsa_add( big->mntsa.e, small.mntsa.e, c->mntsa.e);
+	resultsign = c->mntsa.e[MS_MNTSA] & SIGN_BIT ? 1 : 0;
 	
 /*  check for overflow and shift down if needed  */
 
@@ -292,69 +480,384 @@ void bf_add( FLOAT *a, FLOAT *b, FLOAT *c)
 		if( (!bigsign && resultsign) || (bigsign && !resultsign) 
 			|| (bigsign && smallsign)) 
 		{
-			himask =  SIGN_BIT;
-			for( i = MS_MNTSA; i >= 0; i--)
-			{
-				msb = result.mntsa.e[i] & 1;
-				result.mntsa.e[i] = (result.mntsa.e[i] >> 1) | himask;
-				himask = msb ? SIGN_BIT : 0;
-			}
+			bf_shift_mntsa( c, -1, ~0);
 		}
-		if(bigsign && !resultsign || (bigsign && smallsign)) result.expnt++;
-
-/*  if we have a carry and full null words, then take care of exponent as well */
-
-		i = MS_MNTSA;
-		while( i > 0 && (!result.mntsa.e[i])) i--;
-		if( (i != MS_MNTSA) &&
-				(result.mntsa.e[i] & SIGN_BIT) ) result.expnt++;
+		if( (bigsign && !resultsign) || (bigsign && smallsign)) c->expnt++;
 	}
 	else if( ( !bigsign && resultsign)  ) 
 	{
-		result.expnt++;
-		himask =  0;
-		for( i = MS_MNTSA; i >= 0; i--)
-		{
-			msb = result.mntsa.e[i] & 1;
-			result.mntsa.e[i] = (result.mntsa.e[i] >> 1) | himask;
-			himask = msb ? SIGN_BIT : 0;
-		}
+		c->expnt++;
+		bf_shift_mntsa( c, -1, 0);
 	}
-	bf_normal( &result);
-	bf_copy( &result, c);
+	bf_normal( c);
+}
+
+/*  add two floating point numbers a + b = c.
+	any pointers can be the same.
+*/
+void bf_add( FLOAT *a, FLOAT *b, FLOAT *c)
+{
+	add_core( a, b, 0, c);
 }
 
 /*  because it's useful  c = a - b  */
 
 void bf_subtract( FLOAT *a, FLOAT *b, FLOAT *c)
 {
-	FLOAT	myb;
-	
-	bf_copy( b, &myb);
-	bf_negate( &myb);
-	bf_add( a, &myb, c);
+	add_core( a, b, 1, c);
+}
+
+/*  a = a + b and a = a - b, same as bf_add( a, b, a) and
+	bf_subtract( a, b, a) but say what they mean.
+*/
+
+void bf_add_inplace( FLOAT *a, FLOAT *b)
+{
+	add_core( a, b, 0, a);
+}
+
+void bf_subtract_inplace( FLOAT *a, FLOAT *b)
+{
+	add_core( a, b, 1, a);
+}
+
+/*  Integer and fraction parts by masking the mantissa at the units
+	bit, no adds.  The mantissa is two's complement so clearing the
+	bits below the units bit gives floor(x) for either sign and the
+	bits below it alone are x - floor(x).  With nearest set and the
+	first fraction bit on, the fraction is sign extended to give
+	x - floor(x) - 1 and the integer bumped by one, so round to
+	nearest with ties up costs only a carry.
+	|x| < 1 is shifted to expnt 1 when the integer part isn't 0, that
+	only drops bits an add would have dropped too.
+	ip and fp can be null if not wanted.  Returns low 32 bits of the
+	integer part, exact if it fits in an int.
+*/
+
+/*  check all but the most significant word are zero  */
+
+static int low_zero( FLOAT *x)
+{
+	int		i;
+
+	for( i=0; i<MS_MNTSA; i++) if( x->mntsa.e[i]) return 0;
+	return 1;
+}
+
+static int int_frac( FLOAT *x, FLOAT *ip, FLOAT *fp, int nearest)
+{
+	FLOAT	z, m, in, fr;
+	int		u, wu, bu, i, negflag, bump;
+	ELEMENT	lowmask, fill, n;
+
+	bf_copy( x, &z);
+	negflag = (x->mntsa.e[MS_MNTSA] & SIGN_BIT) ? 1 : 0;
+	if( bf_iszero( x) || (z.expnt < 1))
+	{
+
+/*  see if the integer part is 0 and x is its own fraction  */
+
+		bf_copy( &z, &m);
+		if( negflag) bf_negate( &m);
+		if( bf_iszero( &z) || (!negflag && !(nearest && !z.expnt))
+			|| (negflag && nearest && ((m.expnt < 0) || ((m.expnt == 0)
+			&& (m.mntsa.e[MS_MNTSA] == MSB) && low_zero( &m)))))
+		{
+			if( ip) bf_null( ip);
+			if( fp) bf_copy( &z, fp);
+			return 0;
+		}
+
+/*  arithmetic shift right to expnt 1  */
+
+		bf_shift_mntsa( &z, z.expnt - 1, negflag ? ~0 : 0);
+		z.expnt = 1;
+	}
+
+/*  no fraction bits at all  */
+
+	if( z.expnt >= 32*MNTSA_SIZE - 1)
+	{
+		u = z.expnt - (32*MNTSA_SIZE - 1);
+		n = (u < 32) ? z.mntsa.e[0] << u : 0;
+		if( ip) bf_copy( &z, ip);
+		if( fp) bf_null( fp);
+		return n;
+	}
+
+/*  units bit u, split at word wu bit bu  */
+
+	u = 32*MNTSA_SIZE - 1 - z.expnt;
+	wu = u >> 5;
+	bu = u & 31;
+	lowmask = (1ULL << bu) - 1;
+	n = ( ( ((unsigned long long)((wu < MS_MNTSA) ? z.mntsa.e[wu + 1] :
+			(negflag ? 0xffffffff : 0)) << 32) | z.mntsa.e[wu]) >> bu) & 0xffffffffLL;
+	bump = nearest && ((z.mntsa.e[(u - 1) >> 5] >> ((u - 1) & 31)) & 1);
+	bf_copy( &z, &in);
+	bf_copy( &z, &fr);
+	fill = bump ? ~0 : 0;
+	for( i=0; i<MNTSA_SIZE; i++)
+	{
+		if( i < wu) in.mntsa.e[i] = 0;
+		else if( i > wu) fr.mntsa.e[i] = fill;
+	}
+	in.mntsa.e[wu] &= ~lowmask;
+	fr.mntsa.e[wu] = (fr.mntsa.e[wu] & lowmask) | (fill & ~lowmask);
+	if( fp)
+	{
+		bf_normal( &fr);
+		bf_copy( &fr, fp);
+	}
+	if( bump) n++;
+	if( !ip) return n;
+
+/*  add 1 at units bit.  carry out of a positive number
+	moves the binary point up one.
+*/
+
+	if( bump)
+	{
+		i = wu;
+		in.mntsa.e[i] += 1UL << bu;
+		while( !in.mntsa.e[i] && (i < MS_MNTSA))
+		{
+			i++;
+			in.mntsa.e[i]++;
+		}
+		if( !negflag && (in.mntsa.e[MS_MNTSA] & SIGN_BIT))
+		{
+			bf_shift_mntsa( &in, -1, 0);
+			in.expnt++;
+		}
+		bf_normal( &in);
+	}
+
+/*  floor of a negative can land on -2^expnt which can't be negated  */
+
+	else if( negflag && (in.mntsa.e[MS_MNTSA] == SIGN_BIT) && low_zero( &in))
+	{
+		in.mntsa.e[MS_MNTSA] = SIGN_BIT | MSB;
+		in.expnt++;
+	}
+	bf_copy( &in, ip);
+	return n;
 }
 
-/*  round a float to an integer.  add 1/2 and clear fractional bits.  */
+/*  round to nearest integer, ties go up.  works in place.  */
 
 void bf_round( FLOAT *a, FLOAT *b)
 {
-	FLOAT  half;
-	int i;
-	unsigned long mask;
-	
-	bf_null( &half);
-	half.mntsa.e[MS_MNTSA] = 0x40000000;
-	bf_add( a, &half, b);
-	i = MS_MNTSA - (b->expnt / 32);
-	mask = ~0 << (31 - b->expnt % 32);
-	b->mntsa.e[i] &= mask;
-	i--;
-	while( i >= 0 )
+	int_frac( a, b, 0, 1);
+}
+
+/*  y = largest integer <= x  */
+
+void bf_floor( FLOAT *x, FLOAT *y)
+{
+	int_frac( x, y, 0, 0);
+}
+
+/*  y = smallest integer >= x  */
+
+void bf_ceil( FLOAT *x, FLOAT *y)
+{
+	FLOAT	z;
+
+	bf_copy( x, &z);
+	bf_negate( &z);
+	int_frac( &z, y, 0, 0);
+	bf_negate( y);
+}
+
+/*  y = integer part of x, toward zero  */
+
+void bf_trunc( FLOAT *x, FLOAT *y)
+{
+	if( x->mntsa.e[MS_MNTSA] & SIGN_BIT) bf_ceil( x, y);
+	else bf_floor( x, y);
+}
+
+/*  y = x - floor(x), 0 <= y < 1  */
+
+void bf_frac( FLOAT *x, FLOAT *y)
+{
+	int_frac( x, 0, y, 0);
+}
+
+/*  r = x - n with n the integer nearest x, ties up, so
+	-1/2 <= r < 1/2.  Returns n, exact if it fits in an int and
+	the low bits right always.  works in place.
+*/
+
+int bf_nearest_frac( FLOAT *x, FLOAT *r)
+{
+	return int_frac( x, 0, r, 1);
+}
+
+/*  r = x - ip*y for an integer ip.  |y| is split into a top part
+	with as many low words cleared as ip has bits and the rest, so
+	ip*yhi is exact and near a multiple of y the subtract cancels
+	without rounding.  ip*ylo is small, its rounding is down at the
+	bottom of r.
+*/
+
+static void sub_multiple( FLOAT *x, FLOAT *ip, FLOAT *y, FLOAT *r)
+{
+	FLOAT	yhi, ylo, t;
+	int		i, k;
+
+	k = (ip->expnt + 31) >> 5;
+	if( k < 1) k = 1;
+	if( k > MS_MNTSA) k = MS_MNTSA;
+	bf_copy( y, &ylo);
+	if( ylo.mntsa.e[MS_MNTSA] & SIGN_BIT) bf_negate( &ylo);
+	bf_copy( &ylo, &yhi);
+	for( i=0; i<k; i++) yhi.mntsa.e[i] = 0;
+	bf_subtract( &ylo, &yhi, &ylo);
+	if( y->mntsa.e[MS_MNTSA] & SIGN_BIT)
+	{
+		bf_negate( &yhi);
+		bf_negate( &ylo);
+	}
+	bf_multiply( ip, &yhi, &t);
+	bf_subtract( x, &t, r);
+	bf_multiply( ip, &ylo, &t);
+	bf_subtract( r, &t, r);
+}
+
+/*  r = x - n*y with n = trunc(x/y), so r has the sign of x and
+	|r| < |y|.  n comes from x/y, which can land just off an integer
+	when x is near a multiple of y, so r is found directly as x - n*y
+	and n moved by one if r came out on the wrong side.  r is good to
+	the last bit of x or y, whichever is bigger.
+	quo gets n, exact if it fits in an int.
+	returns 0 if y = 0, 1 otherwise.  r can be x or y.
+*/
+
+int bf_fmod( FLOAT *x, FLOAT *y, FLOAT *r, int *quo)
+{
+	FLOAT	q, ip, t, step;
+	int		n, i, xneg, sq;
+
+	if( !bf_divide( x, y, &q)) return 0;
+	if( q.mntsa.e[MS_MNTSA] & SIGN_BIT)
+	{
+		bf_negate( &q);
+		n = -int_frac( &q, &ip, 0, 0);
+		bf_negate( &ip);
+	}
+	else n = int_frac( &q, &ip, 0, 0);
+	sub_multiple( x, &ip, y, &t);
+
+/*  step is y with the sign of x, each step of r moves n by sq  */
+
+	xneg = (x->mntsa.e[MS_MNTSA] & SIGN_BIT) ? 1 : 0;
+	sq = (xneg ^ ((y->mntsa.e[MS_MNTSA] & SIGN_BIT) ? 1 : 0)) ? -1 : 1;
+	bf_copy( y, &step);
+	if( sq < 0) bf_negate( &step);
+	for( i=0; (i<2) && !bf_iszero( &t); i++)
+	{
+		if( ((t.mntsa.e[MS_MNTSA] & SIGN_BIT) ? 1 : 0) != xneg)
+		{
+			bf_add( &t, &step, &t);
+			n -= sq;
+		}
+		else if( bf_compare( &t, y) >= 0)
+		{
+			bf_subtract( &t, &step, &t);
+			n += sq;
+		}
+		else break;
+	}
+	bf_copy( &t, r);
+	if( quo) *quo = n;
+	return 1;
+}
+
+/*  r = x - n*y with n the integer nearest x/y, ties up, so
+	|r| <= |y|/2.  quo gets n, exact if it fits in an int and
+	the low bits right always (trig quadrants use n mod 4).
+	r is found directly as x - n*y and n moved by one if x/y
+	rounded to the wrong side, same as bf_fmod.
+	returns 0 if y = 0, 1 otherwise.  r can be x or y.
+*/
+
+int bf_remquo( FLOAT *x, FLOAT *y, FLOAT *r, int *quo)
+{
+	FLOAT	q, ip, t, half;
+	int		n, i, c, same;
+
+	if( !bf_divide( x, y, &q)) return 0;
+	n = int_frac( &q, &ip, 0, 1);
+	sub_multiple( x, &ip, y, &t);
+
+/*  r/y = +1/2 is a tie that has to go up to r/y = -1/2  */
+
+	bf_copy( y, &half);
+	half.expnt--;
+	for( i=0; (i<2) && !bf_iszero( &t); i++)
+	{
+		same = !((t.mntsa.e[MS_MNTSA] ^ y->mntsa.e[MS_MNTSA]) & SIGN_BIT);
+		c = bf_compare( &t, &half);
+		if( (c < 0) || ((c == 0) && !same)) break;
+		if( same)
+		{
+			bf_subtract( &t, y, &t);
+			n++;
+		}
+		else
+		{
+			bf_add( &t, y, &t);
+			n--;
+		}
+	}
+	bf_copy( &t, r);
+	if( quo) *quo = n;
+	return 1;
+}
+
+/*  split x into integer part toward zero and fraction with sign
+	of x.  either output can be x.
+*/
+
+void bf_split( FLOAT *x, FLOAT *intprt, FLOAT *frac)
+{
+	FLOAT	z;
+
+	if( x->mntsa.e[MS_MNTSA] & SIGN_BIT)
 	{
-		b->mntsa.e[i] = 0;
-		i--;
+		bf_copy( x, &z);
+		bf_negate( &z);
+		int_frac( &z, intprt, frac, 0);
+		bf_negate( intprt);
+		bf_negate( frac);
 	}
+	else int_frac( x, intprt, frac, 0);
+}
+
+/*  convert a float to an int, toward zero.  Overflow is max
+	possible result.
+*/
+
+int	bf_float_to_int( FLOAT *f)
+{
+	FLOAT	z;
+
+	if( f->expnt < 1) return 0;
+	if( f->expnt > 31)
+	{
+		if( f->mntsa.e[MS_MNTSA] & SIGN_BIT)
+			return SIGN_BIT;
+		return ~SIGN_BIT;
+	}
+	if( f->mntsa.e[MS_MNTSA] & SIGN_BIT)
+	{
+		bf_copy( f, &z);
+		bf_negate( &z);
+		return -int_frac( &z, 0, 0, 0);
+	}
+	return int_frac( f, 0, 0, 0);
 }
 	
 /*  multiply two FLOATS to get a third.
@@ -365,70 +868,90 @@ void bf_round( FLOAT *a, FLOAT *b)
 
 void bf_multiply( FLOAT *a, FLOAT *b, FLOAT *c)
 {
-	int	i, j, k, signflag;
-	FLOAT	mya, myb;
-	unsigned long long int mult, src, dst;
+	bf_multiply_limbs( a, b, bf_work_limbs, c);
+}
 
-/*  figure out sign of result and use unsigned algorithm  */
+/*  same as bf_multiply but only the top limbs words of a and b are
+	used and only the top limbs words of c computed.  Cost goes as
+	limbs^2 instead of MNTSA_SIZE^2.
+*/
 
-	bf_copy( a, &mya);
-	bf_copy( b, &myb);
+void bf_multiply_limbs( FLOAT *a, FLOAT *b, int limbs, FLOAT *c)
+{
+	int	signflag;
+	long	expnt;
+	FLOAT	mya, myb, prod, *pa, *pb, *pc;
+
+/*  figure out sign of result and use unsigned algorithm.  only
+	negative inputs are copied, to take their magnitude.
+*/
+	pa = a;
+	pb = b;
 	signflag = 0;
-	if( mya.mntsa.e[MS_MNTSA] & SIGN_BIT)
+	if( a->mntsa.e[MS_MNTSA] & SIGN_BIT)
 	{
 		signflag = 1;
+		bf_copy( a, &mya);
 		bf_negate( &mya);
+		pa = &mya;
 	}
-	if ( myb.mntsa.e[MS_MNTSA] & SIGN_BIT)
+	if ( b->mntsa.e[MS_MNTSA] & SIGN_BIT)
 	{
 		signflag ^= 1;
+		bf_copy( b, &myb);
 		bf_negate( &myb);
+		pb = &myb;
 	}
+	if( limbs < 2) limbs = 2;
+	if( limbs > MNTSA_SIZE) limbs = MNTSA_SIZE;
+
+/*  compute unnormalized exponent, then the top limbs words of the
+	double length product.  Lowest word is the high half of the mid
+	point column rounded down to zero.  The kernel reads a and b
+	while writing, so the product only goes through prod when c is
+	one of them.
+*/
+	pc = ((c == pa) || (c == pb)) ? &prod : c;
+	expnt = pa->expnt + pb->expnt + 1;
+	mntsa_mul( pa->mntsa.e, pb->mntsa.e, limbs, pc->mntsa.e);
+	pc->expnt = expnt;
+	bf_normal( pc);
+	if (signflag) bf_negate( pc);
+	if( pc != c) bf_copy( pc, c);
+}
 
-/*  compute unnormalized exponent  */
-
-	bf_null( c);
-	c->expnt = mya.expnt + myb.expnt + 1;
+/*  a = a*b, the product needs somewhere to go so this costs one copy  */
 
-/*  use longs and multiply up long longs then sum to 
-	correct place.  Carry only propagates to next word
-	and by order of computation we easily track overflow.
-*/
-	OPLOOP(i)
-	{
+void bf_multiply_inplace( FLOAT *a, FLOAT *b)
+{
+	bf_multiply_limbs( a, b, bf_work_limbs, a);
+}
 
-/*  compute least significant long.  this will be the high
-	order word of the mid point of a full double length
-	multiply.  Round down to zero.
+/*  c = a^2.  Same truncation as bf_multiply_limbs at bf_work_limbs
+	words, but each cross product a[j]*a[k] is only computed once and
+	doubled, so it takes about half the word multiplies.  Sums a
+	column of products at a time in a 96 bit accumulator.  a is only
+	copied if it is negative or is c.
 */
-		j = MS_MNTSA - i;
-		mult = ( (unsigned long long)mya.mntsa.e[i] * 
-				(unsigned long long)myb.mntsa.e[j] ) >> 32;
-		c->mntsa.d[0] += mult;
-	}
 
-/*  compute all full longs and add in correct place  */
+void bf_square( FLOAT *a, FLOAT *c)
+{
+	int	limbs;
+	FLOAT	mya, *pa;
 
-	for ( i=1; i<MNTSA_SIZE; i++)  // i is result index
+	pa = a;
+	if( (a->mntsa.e[MS_MNTSA] & SIGN_BIT) || (a == c))
 	{
-		j = i;
-		k = MS_MNTSA;
-		while ( j < MNTSA_SIZE )
-		{
-			src = ((unsigned long long) c->mntsa.e[i]  << 32) | 
-					( (unsigned long long)c->mntsa.e[i-1]);
-			mult = (unsigned long long)mya.mntsa.e[j] * 
-					(unsigned long long)myb.mntsa.e[k];
-			dst = src + mult;
-			if ( dst < src && (i < MS_MNTSA)) c->mntsa.e[i+1]++;
-			j++;
-			k--;
-			c->mntsa.e[i-1] = dst & 0xffffffffLL;
-			c->mntsa.e[i] =  (dst >> 32) & 0xffffffffLL;
-		}
+		bf_copy( a, &mya);
+		if( a->mntsa.e[MS_MNTSA] & SIGN_BIT) bf_negate( &mya);
+		pa = &mya;
 	}
+	limbs = bf_work_limbs;
+	if( limbs < 2) limbs = 2;
+	if( limbs > MNTSA_SIZE) limbs = MNTSA_SIZE;
+	c->expnt = 2*pa->expnt + 1;
+	mntsa_sqr( pa->mntsa.e, limbs, c->mntsa.e);
 	bf_normal( c);
-	if (signflag) bf_negate( c);
 }
 
 /*  divide FLOATS
@@ -493,9 +1016,11 @@ int bf_reciprical ( FLOAT *b, FLOAT *c)
 	x0.mntsa.d[MS_MNTSAd] = utop << 31;
 	x0.expnt = 1 - myb.expnt;
 
-/*  using guess, compute twice as many bits each step. */
+/*  using guess, compute twice as many bits each step.
+	Stop once bf_work_limbs words are good.
+*/
 
-	for( i=0; i<DIVISION_LOOPS; i++)
+	for( i=0; (i<DIVISION_LOOPS) && ((1 << i) < bf_work_limbs); i++)
 	{
 		bf_multiply( &myb, &x0, &x1);
 		bf_subtract( &two, &x1, &x1);
@@ -517,6 +1042,7 @@ int bf_divide( FLOAT *a, FLOAT *b, FLOAT *c)
 	
 	if ( !bf_reciprical( b, &bottom)) return 0;
 	bf_multiply( a, &bottom, c);
+	return 1;
 }
 
 /*  Square root function.  Start with constants.  Taken 
@@ -530,7 +1056,6 @@ static FLOAT p0, p1, p2, q0, q1;
 void bf_init_float()
 {
 	int			degree;
-	MULTIPOLY	chebary[ MAXCHEB+1];
 	
 /*	ascii_to_float("E 0.1767767142", &p0);
 	ascii_to_float("E 3.696790108", &p1);
@@ -539,76 +1064,74 @@ void bf_init_float()
 	ascii_to_float("E 5.228050594", &q1);
 */	
 	p0.expnt = -2;
-	p0.mntsa.e[0] = 0xb1f96c1d;
-	p0.mntsa.e[1] = 0x4e08339b;
-	p0.mntsa.e[2] = 0x4b8e3962;	/*  0.1767767142 */
-	p0.mntsa.e[3] = 0x67ab2e18;
-	p0.mntsa.e[4] = 0x5f4409fa;
-	p0.mntsa.e[5] = 0xa9df1663;
-	p0.mntsa.e[6] = 0x5dde9567;
-	p0.mntsa.e[7] = 0x5a827a3c;
+	p0.mntsa.e[MS_MNTSA-7] = 0xb1f96c1d;
+	p0.mntsa.e[MS_MNTSA-6] = 0x4e08339b;
+	p0.mntsa.e[MS_MNTSA-5] = 0x4b8e3962;	/*  0.1767767142 */
+	p0.mntsa.e[MS_MNTSA-4] = 0x67ab2e18;
+	p0.mntsa.e[MS_MNTSA-3] = 0x5f4409fa;
+	p0.mntsa.e[MS_MNTSA-2] = 0xa9df1663;
+	p0.mntsa.e[MS_MNTSA-1] = 0x5dde9567;
+	p0.mntsa.e[MS_MNTSA] = 0x5a827a3c;
 	
 	p1.expnt = 2;
-	p1.mntsa.e[0] = 0xa3f42a4b;
-	p1.mntsa.e[1] = 0x90ffdbdc;
-	p1.mntsa.e[2] = 0x9ec61816;	/*  3.696790108 */
-	p1.mntsa.e[3] = 0x6c9416bc;
-	p1.mntsa.e[4] = 0x2bc747ec;
-	p1.mntsa.e[5] = 0xe49d67c9;
-	p1.mntsa.e[6] = 0xc1296f53;
-	p1.mntsa.e[7] = 0x764c1ac4;
+	p1.mntsa.e[MS_MNTSA-7] = 0xa3f42a4b;
+	p1.mntsa.e[MS_MNTSA-6] = 0x90ffdbdc;
+	p1.mntsa.e[MS_MNTSA-5] = 0x9ec61816;	/*  3.696790108 */
+	p1.mntsa.e[MS_MNTSA-4] = 0x6c9416bc;
+	p1.mntsa.e[MS_MNTSA-3] = 0x2bc747ec;
+	p1.mntsa.e[MS_MNTSA-2] = 0xe49d67c9;
+	p1.mntsa.e[MS_MNTSA-1] = 0xc1296f53;
+	p1.mntsa.e[MS_MNTSA] = 0x764c1ac4;
 	
 	p2.expnt = 2;
-	p2.mntsa.e[0] = 0x66caedd4;
-	p2.mntsa.e[1] = 0x7ce7bac2;
-	p2.mntsa.e[2] = 0x460c8755;	/*  3.641977651 */
-	p2.mntsa.e[3] = 0xdfd03d4d;
-	p2.mntsa.e[4] = 0x3ee8fc8b;
-	p2.mntsa.e[5] = 0x567e6f7a;
-	p2.mntsa.e[6] = 0xf9da54a8;
-	p2.mntsa.e[7] = 0x748b14b6;
+	p2.mntsa.e[MS_MNTSA-7] = 0x66caedd4;
+	p2.mntsa.e[MS_MNTSA-6] = 0x7ce7bac2;
+	p2.mntsa.e[MS_MNTSA-5] = 0x460c8755;	/*  3.641977651 */
+	p2.mntsa.e[MS_MNTSA-4] = 0xdfd03d4d;
+	p2.mntsa.e[MS_MNTSA-3] = 0x3ee8fc8b;
+	p2.mntsa.e[MS_MNTSA-2] = 0x567e6f7a;
+	p2.mntsa.e[MS_MNTSA-1] = 0xf9da54a8;
+	p2.mntsa.e[MS_MNTSA] = 0x748b14b6;
 	
 	q0.expnt = 1;
-	q0.mntsa.e[0] = 0xb407eb12;
-	q0.mntsa.e[1] = 0x65f085f5;
-	q0.mntsa.e[2] = 0xd006fa2b;	/*  1.287633631 */
-	q0.mntsa.e[3] = 0xddc3d136;
-	q0.mntsa.e[4] = 0x4e8ce714;
-	q0.mntsa.e[5] = 0xac49b0b4;
-	q0.mntsa.e[6] = 0x97fb9afc;
-	q0.mntsa.e[7] = 0x526896e3;
+	q0.mntsa.e[MS_MNTSA-7] = 0xb407eb12;
+	q0.mntsa.e[MS_MNTSA-6] = 0x65f085f5;
+	q0.mntsa.e[MS_MNTSA-5] = 0xd006fa2b;	/*  1.287633631 */
+	q0.mntsa.e[MS_MNTSA-4] = 0xddc3d136;
+	q0.mntsa.e[MS_MNTSA-3] = 0x4e8ce714;
+	q0.mntsa.e[MS_MNTSA-2] = 0xac49b0b4;
+	q0.mntsa.e[MS_MNTSA-1] = 0x97fb9afc;
+	q0.mntsa.e[MS_MNTSA] = 0x526896e3;
 	
 	q1.expnt = 3;
-	q1.mntsa.e[0] = 0xe3263bb7;
-	q1.mntsa.e[1] = 0xe6ef73fc;
-	q1.mntsa.e[2] = 0x19b79d4b;	/*  5.228050594 */
-	q1.mntsa.e[3] = 0x4dbc06bd;
-	q1.mntsa.e[4] = 0x73b36731;
-	q1.mntsa.e[5] = 0x580a1365;
-	q1.mntsa.e[6] = 0x31039445;
-	q1.mntsa.e[7] = 0x53a61861;
+	q1.mntsa.e[MS_MNTSA-7] = 0xe3263bb7;
+	q1.mntsa.e[MS_MNTSA-6] = 0xe6ef73fc;
+	q1.mntsa.e[MS_MNTSA-5] = 0x19b79d4b;	/*  5.228050594 */
+	q1.mntsa.e[MS_MNTSA-4] = 0x4dbc06bd;
+	q1.mntsa.e[MS_MNTSA-3] = 0x73b36731;
+	q1.mntsa.e[MS_MNTSA-2] = 0x580a1365;
+	q1.mntsa.e[MS_MNTSA-1] = 0x31039445;
+	q1.mntsa.e[MS_MNTSA] = 0x53a61861;
 
 /*  initialize constants for exp and cosine expansions  */
 	
-	degree = bf_gen_chebyshev( chebary, MAXCHEB);
-	if( degree < MAXCHEB)
-	{
-		printf("Max degree %d obtained for chebyshev array. \n", degree);
-		exit(0);
-	}
-	degree = bf_calc_2x_coef( chebary, 44, &twoxcoef);
+	degree = bf_calc_2x_coef( 44, &twoxcoef);
 	if( degree < 44)
 	{
 		printf("Maxdegree %d obtained for 2^x coefficints. \n", degree);
 		exit(0);
 	}
-	degree = bf_calc_cos_coef( chebary, MAXCHEB, &coscoef);
+	degree = bf_calc_cos_coef( MAXCHEB, &coscoef);
 	if( degree < MAXCHEB)
 	{
 		printf("Maxdegree %d obtained for cos coefficints. \n", degree);
 		exit(0);
 	}
-
+	if( !bf_init_exptable())
+	{
+		printf("No space for exp and log tables. \n");
+		exit(0);
+	}
 }
 
 /*  compute real square root of a FLOAT.
@@ -648,7 +1171,8 @@ void bf_square_root( FLOAT *in, FLOAT *out)
 	
 /*  compute 4.7 digits = 15 bits for first estimate.
 	Heron's iteration doubles accuracy every step,
-	so 5 steps gives 500 bits.  Adjust loop as needed.
+	so 5 steps gives 500 bits.  DIVISION_LOOPS + 2 steps
+	covers any mantissa size.
 */
 
 	bf_multiply( &p2, &x, &top);
@@ -661,7 +1185,7 @@ void bf_square_root( FLOAT *in, FLOAT *out)
 	bf_add( &q0, &bottom, &bottom);
 	
 	bf_divide( &top, &bottom, &y);
-	for( i=0; i<5 ; i++)
+	for( i=0; (i<DIVISION_LOOPS+2) && ((15 << i) < 32*bf_work_limbs) ; i++)
 	{
 		bf_divide( &x, &y, &top);
 		bf_add( &y, &top, &y);
@@ -673,6 +1197,102 @@ void bf_square_root( FLOAT *in, FLOAT *out)
 	OPLOOP(i) out->mntsa.e[i] = y.mntsa.e[i];
 }
 
+/*  compute 1/sqrt(|in|).  Same first estimate as bf_square_root
+	turned over with one divide, then Newton's step
+
+		y = y + y*(1 - x*y^2)/2
+
+	which has no divides and doubles the good bits each time.
+	in and out can be the same.  returns 0 if in = 0, 1 otherwise.
+*/
+
+int bf_rsqrt( FLOAT *in, FLOAT *out)
+{
+	FLOAT	x, top, bottom, y, t;
+	int		i, shift;
+
+	if( bf_iszero( in)) return 0;
+	bf_copy( in, &x);
+	if( in->mntsa.e[MS_MNTSA] & SIGN_BIT)
+		bf_negate( &x);
+
+/*  x = xs*2^(2*shift) with 0.25 <= xs < 1  */
+
+	if( x.expnt & 1)
+	{
+		shift = (x.expnt + 1)/2;
+		x.expnt = -1;
+	}
+	else
+	{
+		shift = x.expnt/2;
+		x.expnt = 0;
+	}
+	bf_multiply( &p2, &x, &top);
+	bf_add( &p1, &top, &top);
+	bf_multiply ( &top, &x, &top);
+	bf_add ( &p0, &top, &top);
+	
+	bf_add( &x, &q1, &bottom);
+	bf_multiply(  &x, &bottom, &bottom);
+	bf_add( &q0, &bottom, &bottom);
+	
+	bf_divide( &bottom, &top, &y);
+	for( i=0; (i<DIVISION_LOOPS+2) && ((15 << i) < 32*bf_work_limbs) ; i++)
+	{
+		bf_square( &y, &t);
+		bf_multiply( &x, &t, &t);
+		bf_one( &top);
+		bf_subtract( &top, &t, &t);
+		bf_multiply( &y, &t, &t);
+		t.expnt--;
+		bf_add( &y, &t, &y);
+	}
+	y.expnt -= shift;
+	bf_copy( &y, out);
+	return 1;
+}
+
+/*  h = sqrt(a^2 + b^2).  Both are scaled by the larger exponent
+	so the sum of squares is near 1, and if one is too small to
+	change the result it is just the other one.  Root is taken as
+	s*rsqrt(s).  a, b and h can be the same.
+*/
+
+void bf_hypot( FLOAT *a, FLOAT *b, FLOAT *h)
+{
+	FLOAT	ma, mb, s, r;
+	long	scale;
+
+/*  magnitudes, signs and zero tests taken from a and b so both
+	copies are set on every path before they are read
+*/
+	bf_copy( a, &ma);
+	bf_copy( b, &mb);
+	if( a->mntsa.e[MS_MNTSA] & SIGN_BIT) bf_negate( &ma);
+	if( b->mntsa.e[MS_MNTSA] & SIGN_BIT) bf_negate( &mb);
+	if( bf_iszero( a) || (!bf_iszero( b)
+			&& (mb.expnt - ma.expnt > 16*MNTSA_SIZE + 1)))
+	{
+		bf_copy( &mb, h);
+		return;
+	}
+	if( bf_iszero( b) || (ma.expnt - mb.expnt > 16*MNTSA_SIZE + 1))
+	{
+		bf_copy( &ma, h);
+		return;
+	}
+	scale = (ma.expnt > mb.expnt) ? ma.expnt : mb.expnt;
+	ma.expnt -= scale;
+	mb.expnt -= scale;
+	bf_square( &ma, &s);
+	bf_square( &mb, &r);
+	bf_add( &s, &r, &s);
+	bf_rsqrt( &s, &r);
+	bf_multiply( &s, &r, h);
+	h->expnt += scale;
+}
+
 /*  convert signed 32 bit integer to a float  */
 
 void bf_int_to_float( int num, FLOAT *x)
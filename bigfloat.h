@@ -32,6 +32,32 @@ typedef struct
 	FLOAT	imag;
 } COMPLEX;
 
+/*  ball is midpoint and radius, the true value is somewhere in
+	mid - rad ... mid + rad.  rad is always >= 0.
+*/
+
+typedef struct
+{
+	FLOAT	mid;
+	FLOAT	rad;
+} BALL;
+
+/*  expression node operations, see bigdag.c  */
+
+#define	DAG_CONST	0
+#define	DAG_ADD		1
+#define	DAG_SUB		2
+#define	DAG_MUL		3
+#define	DAG_DIV		4
+#define	DAG_SQRT	5
+#define	DAG_EXP		6
+#define	DAG_COS		7
+#define	DAG_SIN		8
+
+/*  pointer to a function y = f(x), used by approximation tools  */
+
+typedef void (*BF_FUNC)( FLOAT *, FLOAT *);
+
 typedef	short int	INDEX;
 typedef	unsigned long	ELEMENT;
 
@@ -41,6 +67,39 @@ typedef	unsigned long	ELEMENT;
 
 /* Function prototypes produced by cproto(1) */
 
+/* bigball.c */
+void bf_ball_set(FLOAT *, BALL *);
+void bf_ball_copy(BALL *, BALL *);
+int bf_ball_bits(BALL *);
+void bf_ball_add(BALL *, BALL *, BALL *);
+void bf_ball_subtract(BALL *, BALL *, BALL *);
+void bf_ball_multiply(BALL *, BALL *, BALL *);
+int bf_ball_divide(BALL *, BALL *, BALL *);
+int bf_ball_sqrt(BALL *, BALL *);
+int bf_ball_exp(BALL *, BALL *);
+void bf_ball_cosine(BALL *, BALL *);
+void bf_ball_sine(BALL *, BALL *);
+/* bigbatch.c */
+void bf_add_n(FLOAT *, FLOAT *, int, FLOAT *);
+void bf_mul_n(FLOAT *, FLOAT *, int, FLOAT *);
+void bf_fma_n(FLOAT *, FLOAT *, int, FLOAT *);
+void bf_add_n_cmplx(COMPLEX *, COMPLEX *, int, COMPLEX *);
+void bf_mul_n_cmplx(COMPLEX *, COMPLEX *, int, COMPLEX *);
+void bf_fma_n_cmplx(COMPLEX *, COMPLEX *, int, COMPLEX *);
+int bf_array_alloc(BFARRAY *);
+void bf_array_free(BFARRAY *);
+void bf_array_store(BFARRAY, int, FLOAT *);
+void bf_array_load(BFARRAY, int, FLOAT *);
+void bf_array_gather(FLOAT *, int *, BFARRAY);
+void bf_array_scatter(BFARRAY, int *, FLOAT *);
+int bf_array_add(BFARRAY, BFARRAY, BFARRAY);
+int bf_array_mul(BFARRAY, BFARRAY, BFARRAY);
+int bf_array_fma(BFARRAY, BFARRAY, BFARRAY);
+/* bigdag.c */
+void bf_dag_clear(void);
+int bf_dag_const(FLOAT *);
+int bf_dag_op(int, int, int);
+int bf_dag_eval(int, int, FLOAT *);
 /* bigcomplex.c */
 void bf_one(FLOAT *);
 void bf_null_cmplx(COMPLEX *);
@@ -48,42 +107,91 @@ void bf_add_cmplx(COMPLEX *, COMPLEX *, COMPLEX *);
 void bf_subtract_cmplx(COMPLEX *, COMPLEX *, COMPLEX *);
 void bf_multiply_cmplx(COMPLEX *, COMPLEX *, COMPLEX *);
 int bf_divide_cmplx(COMPLEX *, COMPLEX *, COMPLEX *);
+void bf_square_cmplx(COMPLEX *, COMPLEX *);
 int bf_intpwr_cmplx(COMPLEX *, int, COMPLEX *);
+void bf_polyeval_cmplx(MULTIPOLY, COMPLEX *, COMPLEX *);
+void bf_abs2_cmplx(COMPLEX *, FLOAT *);
 void bf_magnitude_cmplx(COMPLEX *, FLOAT *);
+int bf_arg_cmplx(COMPLEX *, FLOAT *);
 int bf_exp_cmplx(COMPLEX *, COMPLEX *);
+int bf_log_cmplx(COMPLEX *, COMPLEX *);
+void bf_sqrt_cmplx(COMPLEX *, COMPLEX *);
+int bf_pow_cmplx(COMPLEX *, COMPLEX *, COMPLEX *);
 /* bigfloat.c */
 void bf_copy(FLOAT *, FLOAT *);
 void bf_copy_cmplx(COMPLEX *, COMPLEX *);
 void bf_null(FLOAT *);
 void bf_negate(FLOAT *);
+int bf_topbit(FLOAT *);
+void bf_shift_mntsa(FLOAT *, int, ELEMENT);
 void bf_normal(FLOAT *);
 int bf_compare(FLOAT *, FLOAT *);
 void bf_add(FLOAT *, FLOAT *, FLOAT *);
 void bf_subtract(FLOAT *, FLOAT *, FLOAT *);
+void bf_add_inplace(FLOAT *, FLOAT *);
+void bf_subtract_inplace(FLOAT *, FLOAT *);
 void bf_round(FLOAT *, FLOAT *);
+void bf_floor(FLOAT *, FLOAT *);
+void bf_ceil(FLOAT *, FLOAT *);
+void bf_trunc(FLOAT *, FLOAT *);
+void bf_frac(FLOAT *, FLOAT *);
+int bf_nearest_frac(FLOAT *, FLOAT *);
+int bf_fmod(FLOAT *, FLOAT *, FLOAT *, int *);
+int bf_remquo(FLOAT *, FLOAT *, FLOAT *, int *);
+void bf_split(FLOAT *, FLOAT *, FLOAT *);
+int bf_float_to_int(FLOAT *);
 void bf_multiply(FLOAT *, FLOAT *, FLOAT *);
+void bf_multiply_limbs(FLOAT *, FLOAT *, int, FLOAT *);
+void bf_multiply_inplace(FLOAT *, FLOAT *);
+void bf_square(FLOAT *, FLOAT *);
 int bf_reciprical(FLOAT *, FLOAT *);
 int bf_divide(FLOAT *, FLOAT *, FLOAT *);
 void bf_init_float(void);
 void bf_square_root(FLOAT *, FLOAT *);
+int bf_rsqrt(FLOAT *, FLOAT *);
+void bf_hypot(FLOAT *, FLOAT *, FLOAT *);
 void bf_int_to_float(int, FLOAT *);
 /* bigfloat.h */
 /* bigfunc.c */
 void bf_calcpi(FLOAT *);
 void bf_calcln2(FLOAT *);
+int bf_window_bits(int);
 int bf_intpwr(FLOAT *, int, FLOAT *);
+int bf_intpwr_n(FLOAT *, int *, int, FLOAT *);
 void bf_bessel(int, int, FLOAT *, FLOAT *);
+void bf_bessel_sequence(int, int, FLOAT *, FLOAT *);
 int bf_gen_chebyshev(MULTIPOLY *, int);
-int bf_calc_2x_coef(MULTIPOLY *, int, MULTIPOLY *);
-int bf_calc_cos_coef(MULTIPOLY *, int, MULTIPOLY *);
+int bf_calc_2x_coef(int, CHEBSERIES *);
+int bf_calc_cos_coef(int, CHEBSERIES *);
+int bf_init_exptable(void);
+void bf_chebeval(CHEBSERIES, FLOAT *, FLOAT *);
 void bf_polyeval(MULTIPOLY, FLOAT *, FLOAT *);
+void bf_exp_burst(FLOAT *, FLOAT *);
+void bf_sincos_burst(FLOAT *, FLOAT *, FLOAT *);
 void bf_twoexp(FLOAT *, FLOAT *);
 void bf_corecos(FLOAT *, FLOAT *);
-int bf_float_to_int(FLOAT *);
+int bf_ph_reduce(FLOAT *, FLOAT *);
+void bf_two_over_pi(FLOAT *);
 int bf_exp(FLOAT *, FLOAT *);
-void bf_split(FLOAT *, FLOAT *, FLOAT *);
+int bf_log(FLOAT *, FLOAT *);
+int bf_log1p(FLOAT *, FLOAT *);
+void bf_agm(FLOAT *, FLOAT *, FLOAT *);
+int bf_log_agm(FLOAT *, FLOAT *);
+int bf_log2(FLOAT *, FLOAT *);
+int bf_log10(FLOAT *, FLOAT *);
 void bf_cosine(FLOAT *, FLOAT *);
 void bf_sine(FLOAT *, FLOAT *);
+void bf_sincos(FLOAT *, FLOAT *, FLOAT *);
+int bf_can_round(FLOAT *, int, int);
+void bf_round_bits(FLOAT *, int, FLOAT *);
+int bf_exp_bits(FLOAT *, int, FLOAT *);
+void bf_twoexp_bits(FLOAT *, int, FLOAT *);
+void bf_cosine_bits(FLOAT *, int, FLOAT *);
+void bf_sine_bits(FLOAT *, int, FLOAT *);
+int bf_atan2(FLOAT *, FLOAT *, FLOAT *);
+int bf_exp_ziv(FLOAT *, int, FLOAT *);
+int bf_cosine_ziv(FLOAT *, int, FLOAT *);
+int bf_sine_ziv(FLOAT *, int, FLOAT *);
 /* bigio.c */
 int bf_ascii_to_float(char *, FLOAT *);
 void bf_float_to_ascii(FLOAT *, char *);
@@ -91,3 +199,9 @@ char bf_digitof(FLOAT *);
 int bf_iszero(FLOAT *);
 void bf_printfloat(char *, FLOAT *);
 void bf_print_cmplx(char *, COMPLEX *);
+/* bigremez.c */
+int bf_remez(BF_FUNC, FLOAT *, FLOAT *, int, CHEBSERIES *, FLOAT *);
+int bf_minimax(BF_FUNC, FLOAT *, FLOAT *, int, int, CHEBSERIES *);
+int bf_cheb_to_poly(CHEBSERIES, MULTIPOLY *);
+void bf_print_series(char *, MULTIPOLY);
+int bf_init_minimax(int);
@@ -14,50 +14,98 @@
 #include "bigfloat.h"
 #include "multipoly.h"
 
-void bf_split( FLOAT *x, FLOAT *intprt, FLOAT *frac);
+static void cos_halfpi( FLOAT *t, CHEBSERIES cs, FLOAT *y);
+static int exp_core( FLOAT *x, MULTIPOLY poly, FLOAT *y);
+static void cosine_core( FLOAT *x, CHEBSERIES cs, FLOAT *y);
+static void sine_core( FLOAT *x, CHEBSERIES cs, FLOAT *y);
 
 extern RAMDATA ram_block[];
+extern int bf_work_limbs;
 
-MULTIPOLY	twoxcoef;		/*  2^x expansion series coefficients  */
-MULTIPOLY	coscoef;		/*  cos(x)  expansion series coefficients  */
+CHEBSERIES	twoxcoef;		/*  2^x Chebyshev series coefficients  */
+CHEBSERIES	coscoef;		/*  cos(x)  Chebyshev series coefficients  */
+CHEBSERIES	minitwox;		/*  2^x minimax series from bf_init_minimax  */
+CHEBSERIES	minicos;		/*  cos(x) minimax series  */
+int			minibits = 0;	/*  both good to 2^-minibits, 0 if not built  */
 FLOAT		P2;			/*  PI/2  */
 FLOAT		ln2;			/*  ln(2)	*/
+FLOAT		invln2;		/*  1/ln(2)  */
+FLOAT		invP2;		/*  2/PI  */
+FLOAT		invln10;		/*  1/ln(10)  */
+MULTIPOLY	exptable;		/*  2^(j/2^EXP_TABLE_BITS), j = 0 ... 2^EXP_TABLE_BITS - 1  */
+MULTIPOLY	expcoef;		/*  1/n!, Taylor series of exp on table residual  */
+MULTIPOLY	logcoef;		/*  1/(2n+1), series of atanh(w)/w in w^2  */
 
-/*  compute pi to 250 bits  or so.  
-	Uses formula arcsin(1/2) = pi/6 = pi/2 - 1 - sum(
-		1*3*5*...*(2k-1))/(2^3k (2k+1) k!)
+/*  2/PI to 2048 bits, most significant word first, binary point
+	before first word.  Used by Payne-Hanek reduction of large trig
+	arguments, which only needs the bits near the binary point of x.
 */
+
+#define	PH_SIZE		(MNTSA_SIZE + (32*MNTSA_SIZE + PH_GUARD + 32)/32 + 2)
+
+static ELEMENT two_over_pi[TWOPI_WORDS] =
+{
+	0xa2f9836e, 0x4e441529, 0xfc2757d1, 0xf534ddc0,
+	0xdb629599, 0x3c439041, 0xfe5163ab, 0xdebbc561,
+	0xb7246e3a, 0x424dd2e0, 0x06492eea, 0x09d1921c,
+	0xfe1deb1c, 0xb129a73e, 0xe88235f5, 0x2ebb4484,
+	0xe99c7026, 0xb45f7e41, 0x3991d639, 0x835339f4,
+	0x9c845f8b, 0xbdf9283b, 0x1ff897ff, 0xde05980f,
+	0xef2f118b, 0x5a0a6d1f, 0x6d367ecf, 0x27cb09b7,
+	0x4f463f66, 0x9e5fea2d, 0x7527bac7, 0xebe5f17b,
+	0x3d0739f7, 0x8a5292ea, 0x6bfb5fb1, 0x1f8d5d08,
+	0x56033046, 0xfc7b6bab, 0xf0cfbc20, 0x9af4361d,
+	0xa9e39161, 0x5ee61b08, 0x6599855f, 0x14a06840,
+	0x8dffd880, 0x4d732731, 0x06061556, 0xca73a8c9,
+	0x60e27bc0, 0x8c6b47c4, 0x19c367cd, 0xdce8092a,
+	0x8359c476, 0x8b961ca6, 0xddaf44d1, 0x5719053e,
+	0xa5ff0705, 0x3f7e33e8, 0x32c2de4f, 0x98327dbb,
+	0xc33d26ef, 0x6b1e5ef8, 0x9f3a1f35, 0xcaf27f1d
+};
+
+/*  compute pi to full mantissa precision with the Gauss-Legendre
+	iteration:
+		a0 = 1, b0 = 1/sqrt(2), t0 = 1/4, p0 = 1
+		a = (a+b)/2, b = sqrt(a*b), t = t - p*(a - a')^2, p = 2*p
+		pi = (a+b)^2/(4t)
+	Correct bits double every step, so about 8 steps at 256 bits.
+*/
+
 void bf_calcpi( FLOAT *pi)
 {
-	FLOAT tn, constant;
-	int i;
-	
-	bf_null( pi);
-	bf_int_to_float( 1, &tn);
-	tn.expnt = -2;
-	bf_int_to_float( 3, &constant);
-	bf_divide( &tn, &constant, &tn);
-	bf_add( pi, &tn, pi);
-	for( i=2; i<123; i++)
-	{
-		bf_int_to_float( 2*i-1, &constant);
-		bf_multiply(&constant, &constant, &constant);
-		bf_multiply( &constant, &tn, &tn);
-		bf_int_to_float( 2*i+1, &constant);
-		bf_divide( &tn, &constant, &tn);
-		bf_int_to_float( i, &constant);
-		bf_divide( &tn, &constant, &tn);
-		tn.expnt -= 3;
-		bf_add( &tn, pi, pi);
-	}
-	bf_int_to_float( 1, &constant);
-	bf_add( &constant, pi, pi);
-	bf_int_to_float( 3, &constant);
-	bf_multiply( &constant, pi, pi);
+	FLOAT	a, b, t, an, d;
+	int		p, i;
+
+	bf_one( &a);
+	bf_one( &b);
+	b.expnt++;
+	bf_square_root( &b, &b);
+	bf_reciprical( &b, &b);
+	bf_one( &t);
+	t.expnt -= 2;
+	p = 0;
+	for( i=0; i<AGM_LOOPS; i++)
+	{
+		bf_add( &a, &b, &an);
+		an.expnt--;
+		bf_multiply( &a, &b, &b);
+		bf_square_root( &b, &b);
+		bf_subtract( &a, &an, &d);
+		bf_copy( &an, &a);
+		if( bf_iszero( &d)) break;
+		bf_multiply( &d, &d, &d);
+		d.expnt += p;
+		bf_subtract( &t, &d, &t);
+		p++;
+		if( d.expnt < -32*MNTSA_SIZE - 4) break;
+	}
+	bf_add( &a, &b, &a);
+	bf_multiply( &a, &a, &a);
+	t.expnt += 2;
+	bf_divide( &a, &t, pi);
 }
 
 /*  Output of above routine is:
-tn.expnt = -256
 pi = 
 E +3.14159265358979323846264338327950288419716939937\
 	510582097494459230781640628585258
@@ -68,7 +116,7 @@ pi.mntsa.e[] = {
                      }
 */
 
-/*  compute ln(2) to 256 bits.
+/*  compute ln(2) to full mantissa precision.
 	ln(2) = 2 sum( 1/( (2k+1) * 3^(2k+1) )
 	which converges in about 70+ terms.
 */
@@ -86,7 +134,7 @@ void bf_calcln2( FLOAT *ln2)
 	epsilon = 1;
 	k = 0;
 	
-	while( epsilon > -256)
+	while( epsilon > -32*MNTSA_SIZE)
 	{
 		bf_add( &tk, ln2, ln2);
 		bf_int_to_float( 2*k+1, &constant);
@@ -100,42 +148,168 @@ void bf_calcln2( FLOAT *ln2)
 	ln2->expnt++;		// final multiply by 2
 }
 
+/*  window width for sliding window powers of an nbits exponent.
+	Table of odd powers costs 2^(w-1) multiplies, saves about
+	nbits/(w+1) of them.
+*/
+
+int bf_window_bits( int nbits)
+{
+	if( nbits <= 4) return 1;
+	if( nbits <= 10) return 2;
+	if( nbits <= 24) return 3;
+	return INTPWR_WINDOW;
+}
+
 /*  compute y = x^k
 	where k is a signed integer in range +/- 2^31 and x, y are FLOAT.
-	Copied from complex version.
+	Sliding window, left to right:  odd powers x, x^3, ... x^(2^w - 1)
+	are made first, then each run of up to w bits starting and ending
+	with a 1 costs one table multiply, every bit costs a square.
 	Returns 1 if ok, 0 if x = 0 and k<0
 */
 
 int bf_intpwr( FLOAT *x, int k, FLOAT *y)
 {
-	int signflag, n;
-	FLOAT z, t;
+	FLOAT		odd[1 << (INTPWR_WINDOW - 1)], x2, t;
+	unsigned int	n, value;
+	int			i, l, w, nbits, started;
 	
-/*  initialize Knuth's algorithm A pg 442 V2  */
-
-	bf_copy( x, &z);
-	if( k<0)
+	n = (k < 0) ? -(unsigned int)k : (unsigned int)k;
+	if( !n)
 	{
-		signflag = -1;
-		n = -k;
+		bf_one( y);
+		return 1;
 	}
-	else
+	nbits = 0;
+	while( (nbits < 32) && (n >> nbits)) nbits++;
+	w = bf_window_bits( nbits);
+	bf_copy( x, &odd[0]);
+	if( w > 1)
 	{
-		signflag = 0;
-		n = k;
+		bf_square( x, &x2);
+		for( i=1; i < (1 << (w - 1)); i++)
+			bf_multiply( &odd[i-1], &x2, &odd[i]);
 	}
-	bf_int_to_float( 1, &t);
-	while( n)
+	started = 0;
+	i = nbits - 1;
+	while( i >= 0)
 	{
-		if( n & 1) bf_multiply( &t, &z, &t);
-		bf_multiply( &z, &z, &z);
-		n >>= 1;
+		if( !((n >> i) & 1))
+		{
+			bf_square( &t, &t);
+			i--;
+			continue;
+		}
+		l = i - w + 1;
+		if( l < 0) l = 0;
+		while( !((n >> l) & 1)) l++;
+		value = (n >> l) & ((1U << (i - l + 1)) - 1);
+		if( started)
+		{
+			for( ; i >= l; i--) bf_square( &t, &t);
+			bf_multiply( &t, &odd[value >> 1], &t);
+		}
+		else
+		{
+			bf_copy( &odd[value >> 1], &t);
+			started = 1;
+		}
+		i = l - 1;
 	}
-	if( signflag) return bf_reciprical( &t, y);
+	if( k < 0) return bf_reciprical( &t, y);
 	bf_copy( &t, y);
 	return 1;
 }
 
+/*  compute y[i] = x^k[i] for i = 0 ... count-1 with one shared table.
+	Fixed window base 2^w:  table holds x^(d*2^(w*g)) for digits
+	d = 1 ... 2^w - 1 and each group g, so every exponent only costs one
+	multiply per nonzero digit and no squares.  w is picked to balance
+	table cost against count.  Table lives in pool space.
+	Returns 1 if ok, 0 if no space or x = 0 with some k < 0.
+*/
+
+int bf_intpwr_n( FLOAT *x, int *k, int count, FLOAT *y)
+{
+	MULTIPOLY		table;
+	FLOAT			*tptr, t;
+	unsigned int	n, maxn, digit;
+	int				i, g, d, w, bestw, groups, nbits, cost, bestcost, rtn, started;
+
+	maxn = 0;
+	for( i=0; i<count; i++)
+	{
+		n = (k[i] < 0) ? -(unsigned int)k[i] : (unsigned int)k[i];
+		if( n > maxn) maxn = n;
+	}
+	nbits = 0;
+	while( (nbits < 32) && (maxn >> nbits)) nbits++;
+	if( !nbits) nbits = 1;
+
+/*  table costs groups*(2^w - 1) multiplies, each exponent at most groups  */
+
+	bestw = 1;
+	bestcost = 0x7fffffff;
+	for( w=1; w<=INTPWR_WINDOW; w++)
+	{
+		groups = (nbits + w - 1)/w;
+		cost = groups*((1 << w) - 1) + count*groups;
+		if( cost < bestcost)
+		{
+			bestcost = cost;
+			bestw = w;
+		}
+	}
+	w = bestw;
+	groups = (nbits + w - 1)/w;
+	table.degree = groups*((1 << w) - 1) - 1;
+	if( !bf_get_space( &table)) return 0;
+
+/*  entry g*(2^w - 1) + d - 1 is x^(d*2^(w*g))  */
+
+	tptr = Address( table);
+	bf_copy( x, tptr);
+	for( g=0; g<groups; g++)
+	{
+		tptr = Address( table) + g*((1 << w) - 1);
+		if( g)
+		{
+			bf_copy( tptr - 1, tptr);
+			bf_multiply( tptr, tptr - (1 << w) + 1, tptr);
+		}
+		for( d=2; d < (1 << w); d++)
+			bf_multiply( tptr + d - 2, tptr, tptr + d - 1);
+	}
+
+	rtn = 1;
+	for( i=0; i<count; i++)
+	{
+		n = (k[i] < 0) ? -(unsigned int)k[i] : (unsigned int)k[i];
+		started = 0;
+		bf_one( &t);
+		for( g=0; g<groups; g++)
+		{
+			digit = (n >> (w*g)) & ((1U << w) - 1);
+			if( !digit) continue;
+			tptr = Address( table) + g*((1 << w) - 1) + digit - 1;
+			if( started) bf_multiply( &t, tptr, &t);
+			else
+			{
+				bf_copy( tptr, &t);
+				started = 1;
+			}
+		}
+		if( k[i] < 0)
+		{
+			if( !bf_reciprical( &t, &y[i])) rtn = 0;
+		}
+		else bf_copy( &t, &y[i]);
+	}
+	bf_free_space( &table);
+	return rtn;
+}
+
 /*  This routine computes bessel functions for real arguments
 	for nth order to accuracy of 256 bits.  Accuracy is easy to 
 	change, assuming storage chages.  Purpose is coefficients
@@ -194,6 +368,111 @@ void bf_bessel( int type, int n, FLOAT *x, FLOAT *y)
 	bf_multiply( &t1, &sum, y);
 }
 
+/*  Compute a whole sequence of bessel functions at once with
+	Miller's backward recurrence.
+	
+		J(n-1, x) = (2n/x)*J(n, x) - J(n+1, x)
+		I(n-1, x) = (2n/x)*I(n, x) + I(n+1, x)
+	
+	Start well above nmax with arbitrary values and run down to 0,
+	the wanted solution dominates.  Normalize once with
+	
+		J(0, x) + 2*sum{ J(2k, x)} = 1
+		I(0, x) + 2*sum{ I(k, x)} = exp(x)
+	
+	Enter with type = +1 for In(x) and type = -1 for Jn(x), maximum
+	order nmax, FLOAT pointing to x and array of nmax+1 FLOATs.
+	Returns with out[n] = Jn(x) or In(x) for n = 0 ... nmax.
+	Two multiplies per order, versus a full series for each order
+	with bf_bessel.
+*/
+
+void bf_bessel_sequence( int type, int nmax, FLOAT *x, FLOAT *out)
+{
+	FLOAT	ax, rx, fn, fn1, fn2, sum, scale, constant;
+	int		n, start, bits, lg, signflag;
+	
+	if( bf_iszero( x))
+	{
+		bf_int_to_float( 1, &out[0]);
+		for( n=1; n<=nmax; n++) bf_null( &out[n]);
+		return;
+	}
+	bf_copy( x, &ax);
+	signflag = 0;
+	if( ax.mntsa.e[MS_MNTSA] & SIGN_BIT)
+	{
+		bf_negate( &ax);
+		signflag = 1;
+	}
+
+/*  each order past x/2 drops the terms by about 2n/x.  Start high
+	enough that the starting error is below our precision.
+*/
+
+	start = nmax;
+	bits = 0;
+	while( bits < 32*MNTSA_SIZE + 16)
+	{
+		start++;
+		lg = 0;
+		for( n=2*start; n>1; n >>= 1) lg++;
+		if( lg > ax.expnt) bits += lg - ax.expnt;
+	}
+
+/*  rx = 2/x, run recurrence down from start  */
+
+	bf_reciprical( &ax, &rx);
+	rx.expnt++;
+	bf_null( &fn2);
+	bf_one( &fn1);
+	bf_null( &sum);
+	for( n=start; n>0; n--)
+	{
+		bf_int_to_float( n, &constant);
+		bf_multiply( &constant, &rx, &constant);
+		bf_multiply( &constant, &fn1, &fn);
+		if( type < 0) bf_subtract( &fn, &fn2, &fn);
+		else bf_add( &fn, &fn2, &fn);
+		bf_copy( &fn1, &fn2);
+		bf_copy( &fn, &fn1);
+
+/*  fn is now order n-1.  Save if wanted and add to normalizing sum  */
+
+		if( n-1 <= nmax) bf_copy( &fn, &out[n-1]);
+		if( n-1 == 0) continue;
+		if( (type < 0) && ((n-1) & 1)) continue;
+		bf_copy( &fn, &constant);
+		constant.expnt++;
+		bf_add( &constant, &sum, &sum);
+	}
+	bf_add( &fn, &sum, &sum);
+
+/*  find scale factor, exp(|x|) for In and 1 for Jn  */
+
+	if( type < 0) bf_reciprical( &sum, &scale);
+	else
+	{
+		bf_one( &fn);
+		bf_one( &fn1);
+		n = 0;
+		while( fn1.expnt - fn.expnt > -32*MNTSA_SIZE)
+		{
+			n++;
+			bf_multiply( &fn1, &ax, &fn1);
+			bf_int_to_float( n, &constant);
+			bf_divide( &fn1, &constant, &fn1);
+			bf_add( &fn1, &fn, &fn);
+		}
+		bf_divide( &fn, &sum, &scale);
+	}
+	for( n=0; n<=nmax; n++)
+	{
+		bf_multiply( &scale, &out[n], &out[n]);
+		if( signflag && (n & 1)) bf_negate( &out[n]);
+	}
+}
+
 /* create table of chebyshev polynomials.
 	Enter with maximum degree desired and array large
 	enough to hold the MULTIPOLY data pointers.
@@ -247,130 +526,185 @@ chebdie:
 	return numgen;
 }
 
-/*  compute coefficients of 2^x using Chebyshev polynomials.
+/*  compute coefficients of 2^x as a Chebyshev series.
 	
 	2^x  =  I(o, ln(2)) + sum{ 2*I(n, ln(2))*T(n, x)} n = 1... oo
 	
-	Enter with pointer to table of cheybshev polynomials, 
-	maximum degree of approximation and pointer to where
+	Coefficients are kept in the Chebyshev basis and evaluated with
+	Clenshaw's recurrence (bf_chebeval), so there is no conversion to
+	a power series in x.
+	Enter with maximum degree of approximation and pointer to where
 	you want result.
-	Returns with power series in x of above, and max degree
-	actually computed.
+	Returns max degree actually computed, 0 if no space.
 */
 
-int bf_calc_2x_coef( MULTIPOLY *cheb,  int maxdegree, 
-				MULTIPOLY *twoxcoef)
+int bf_calc_2x_coef( int maxdegree, CHEBSERIES *twoxcoef)
 {
-	INDEX		i, j;
-	FLOAT		ibesl, *iptr;
-	MULTIPOLY	tnterm, sum;
-	
-	char		test[32];
+	INDEX		i;
+	FLOAT		*iptr;
 	
 	bf_calcln2( &ln2);
 	
-	sum.degree = 0;
-	if( !bf_get_space( &sum))
+	twoxcoef->degree = maxdegree;
+	if( !bf_get_space( twoxcoef))
 	{
 		printf(" no space left, calc_2x_coef \n");
 		return 0;
 	}
-	iptr = Address(sum);
-	bf_bessel (+1, 0, &ln2, iptr);
-	for( i=1; i<=maxdegree; i++)
-	{
-		bf_bessel( +1, i, &ln2, &ibesl);
-		ibesl.expnt++;
-		bf_multi_dup( cheb[i], &tnterm);
-		for( j = (i&1); j<=i; j += 2)
-		{
-			iptr = Address( tnterm) + j;
-			bf_multiply( &ibesl, iptr, iptr);
-		}
-		if( !bf_multi_add( tnterm, sum, &sum)) break;
-		bf_free_space( &tnterm);
-	}
-	if( i< maxdegree)  bf_free_space( &tnterm);
-	else i = maxdegree;
-	bf_multi_dup( sum, twoxcoef);
-	bf_free_space( &sum);
-	return (i);
+	iptr = AddressOf( twoxcoef);
+	bf_bessel_sequence( +1, maxdegree, &ln2, iptr);
+	for( i=1; i<=maxdegree; i++) iptr[i].expnt++;
+	return (maxdegree);
 }
 
-/*  compute coefficients of cos(x*PI/2) using Chebyshev polynomials.
+/*  compute coefficients of cos(x*PI/2) as a Chebyshev series.
 	
-	cos(x*P2)  =   J(0, P2) + 2*sum{(-1)^n*J(2n, P2)*T(2n+1, x)} n = 1... oo
+	cos(x*P2)  =   J(0, P2) + 2*sum{(-1)^n*J(2n, P2)*T(2n, x)} n = 1... oo
 	
-	Enter with pointer to table of cheybshev polynomials, 
-	maximum degree of approximation and pointer to where
-	you want result.
-	Returns with power series in x^2 of above, and max degree
-	actually computed.  cos( x*PI/2) = sum{ a_j * (x^2)^j}.
+	Only even terms appear and T(2n, x) = T(n, 2x^2 - 1), so the result
+	is stored as a Chebyshev series in u = 2x^2 - 1 with coefficient
+	n = 2*(-1)^n*J(2n, P2).  Enter with maximum degree in x and pointer
+	to where you want result.
+	Returns max degree in x actually computed, 0 if no space.
 	
 	NOTE:  All formulas in all the books I found are WRONG.  None have
 	the (-1)^n factor, but they act like it's there when constructing
 	the polynomial.
 */
 
-int bf_calc_cos_coef( MULTIPOLY *cheb,  int maxdegree, 
-				MULTIPOLY *coscoef)
+int bf_calc_cos_coef( int maxdegree, CHEBSERIES *coscoef)
 {
-	INDEX		i, j, k;
-	FLOAT		jbesl, *jptr, *kptr;
-	MULTIPOLY	tnterm, sum;
-	
-	char		test[32];
+	INDEX		i;
+	FLOAT		*jptr, *kptr;
+	MULTIPOLY	jbesl;
 
 	bf_calcpi( &P2);
 	P2.expnt--;
-	sum.degree = 0;
-	if( !bf_get_space( &sum))
+	bf_reciprical( &P2, &invP2);
+	coscoef->degree = maxdegree/2;
+	jbesl.degree = 2*coscoef->degree;
+	if( !bf_get_space( coscoef) || !bf_get_space( &jbesl))
 	{
-		printf(" no space left, calc_cos_coef \n");
+		printf(" no space for cosine.\n");
 		return 0;
 	}
-	jptr = Address(sum);
-	bf_bessel(-1, 0, &P2, jptr);
-	for( i=1; i<=maxdegree/2; i++)
-	{
-		k = 2*i;
-		bf_bessel( -1, k, &P2, &jbesl);
-		jbesl.expnt++;
-		if( i&1) bf_negate( &jbesl);
-		bf_multi_dup( cheb[k], &tnterm);
-		jptr = Address( tnterm);
-		for( j = 0; j<=k; j += 2)
+	kptr = Address( jbesl);
+	bf_bessel_sequence( -1, jbesl.degree, &P2, kptr);
+	for( i=0; i<=coscoef->degree; i++)
+	{
+		jptr = AddressOf( coscoef) + i;
+		bf_copy( kptr + 2*i, jptr);
+		if( !i) continue;
+		jptr->expnt++;
+		if( i&1) bf_negate( jptr);
+	}
+	bf_free_space( &jbesl);
+	return (2*coscoef->degree);
+}
+
+/*  build tables for table driven exp and log.
+	exptable holds 2^(j/2^k) for k = EXP_TABLE_BITS, computed with the
+	2^x core, so twoxcoef and ln2 must already exist.  The residual after
+	table lookup is less than 2^-k, so short Taylor series are enough:
+	expcoef and logcoef are sized so the first dropped term is below
+	the mantissa.
+	Returns 1 if ok, 0 if no space.
+*/
+
+int bf_init_exptable()
+{
+	INDEX	i, size, bits, lg, n;
+	FLOAT	x, *fptr;
+
+	size = 1 << EXP_TABLE_BITS;
+	exptable.degree = size - 1;
+	if( !bf_get_space( &exptable)) return 0;
+	bf_int_to_float( size, &x);
+	for( i=0; i<size; i++)
+	{
+		fptr = Address( exptable) + i;
+		bf_int_to_float( i, fptr);
+		bf_divide( fptr, &x, fptr);
+		if( MNTSA_SIZE < BURST_MNTSA) bf_twoexp( fptr, fptr);
+		else
 		{
-			bf_multiply( &jbesl, jptr, jptr);
-			jptr += 2;
+			bf_multiply( fptr, &ln2, fptr);
+			bf_exp_burst( fptr, fptr);
 		}
-		if( !bf_multi_add( tnterm, sum, &sum)) break;
-		bf_free_space( &tnterm);
 	}
-	if( i< maxdegree/2)  
+	bf_reciprical( &ln2, &invln2);
+
+/*  term n of exp(s) is s^n/n! with s < 2^-k  */
+
+	bits = 0;
+	n = 0;
+	while( bits < 32*MNTSA_SIZE + 8)
+	{
+		n++;
+		lg = 0;
+		for( i=n; i>1; i >>= 1) lg++;
+		bits += EXP_TABLE_BITS + lg;
+	}
+	expcoef.degree = n - 1;
+	if( !bf_get_space( &expcoef)) return 0;
+	fptr = Address( expcoef);
+	bf_one( fptr);
+	for( i=1; i<=expcoef.degree; i++)
 	{
-		bf_free_space( &tnterm);
-		i = 2*i;
+		bf_int_to_float( i, &x);
+		bf_divide( fptr + i - 1, &x, fptr + i);
 	}
-	else i = maxdegree;
 
-/*  convert to polynomial in x^2  */
+/*  log(1+u) = 2*atanh(w), w = u/(2+u) < 2^-(k+1), series in w^2  */
 
-	j = sum.degree/2;
-	coscoef->degree = j;
-	if( !bf_get_space(coscoef))
+	logcoef.degree = (32*MNTSA_SIZE + 8)/(2*EXP_TABLE_BITS + 2);
+	if( !bf_get_space( &logcoef)) return 0;
+	for( i=0; i<=logcoef.degree; i++)
 	{
-		printf(" no space for cosine.\n");
-		return 0;
+		fptr = Address( logcoef) + i;
+		bf_one( fptr);
+		bf_int_to_float( 2*i+1, &x);
+		bf_divide( fptr, &x, fptr);
 	}
-	for( k=0; k<=j; k++)
+	bf_int_to_float( 10, &x);
+	bf_log( &x, &x);
+	bf_reciprical( &x, &invln10);
+	return 1;
+}
+
+/*  evaluate Chebyshev series with Clenshaw's recurrence.
+	
+	b(k) = c(k) + 2x*b(k+1) - b(k+2),  F(x) = c(0) + x*b(1) - b(2)
+	
+	One multiply per degree, and since no large monomial coefficients
+	cancel, it needs no extra guard bits for |x| <= 1.
+	Input:  CHEBSERIES coefficients, pointer to x, pointer to y
+	Output:  y = F(x)
+	y can equal x
+*/
+
+void bf_chebeval( CHEBSERIES coef, FLOAT *x, FLOAT *y)
+{
+	INDEX	k;
+	FLOAT	twox, b1, b2, temp, *cof;
+
+	bf_copy( x, &twox);
+	twox.expnt++;
+	bf_null( &b1);
+	bf_null( &b2);
+	for( k=coef.degree; k>0; k--)
 	{
-		kptr = AddressOf( coscoef) + k;
-		jptr = Address( sum) + 2*k;
-		bf_copy( jptr, kptr);
+		cof = Address( coef) + k;
+		bf_multiply( &twox, &b1, &temp);
+		bf_subtract( &temp, &b2, &temp);
+		bf_copy( &b1, &b2);
+		bf_add( cof, &temp, &b1);
 	}
-	bf_free_space( &sum);
-	return (i);
+	twox.expnt--;
+	bf_multiply( &twox, &b1, &temp);
+	bf_subtract( &temp, &b2, &temp);
+	cof = Address( coef);
+	bf_add( cof, &temp, y);
 }
 
 /*  evaluate simple polynomial.
@@ -395,6 +729,168 @@ void bf_polyeval( MULTIPOLY coef, FLOAT *x, FLOAT *y)
 	bf_add( cof, &sum, y);
 }
 
+/*  Bit-burst evaluation for high precision.
+	Split x into chunks x = x0 + x1 + ... where chunk k holds the next
+	BURST_START*2^k bits.  Then exp(x) = prod{ exp(xk)} and the series
+	for each chunk has a short numerator and converges faster the
+	further down the chunk is.  Each series is summed by binary splitting:
+	
+		S = sum{ prod{ p/q(k)} k = 1 ... n} n = 0 ... N-1 = T(0, N)/Q(0, N)
+		P = P1*P2, Q = Q1*Q2, T = T1*Q2 + P1*T2
+	
+	so almost all multiplies have short operands.
+	Series type 0 is exp(p) with q(k) = k, type 1 is cos with
+	p = -x^2, q(k) = (2k-1)*2k and type 2 is sin(x)/x with p = -x^2,
+	q(k) = 2k*(2k+1).
+*/
+
+static int burst_q( int type, int k)
+{
+	if( !type) return k;
+	if( type == 1) return (2*k-1)*2*k;
+	return 2*k*(2*k+1);
+}
+
+static void burst_split( int type, FLOAT *p, int a, int b,
+				FLOAT *P, FLOAT *Q, FLOAT *T)
+{
+	FLOAT	P2s, Q2s, T2s, temp;
+	int		m;
+
+	if( b - a == 1)
+	{
+		if( !a)
+		{
+			bf_one( P);
+			bf_one( Q);
+			bf_one( T);
+			return;
+		}
+		bf_copy( p, P);
+		bf_int_to_float( burst_q( type, a), Q);
+		bf_copy( p, T);
+		return;
+	}
+	m = (a + b)/2;
+	burst_split( type, p, a, m, P, Q, T);
+	burst_split( type, p, m, b, &P2s, &Q2s, &T2s);
+	bf_multiply( T, &Q2s, T);
+	bf_multiply( P, &T2s, &temp);
+	bf_add( T, &temp, T);
+	bf_multiply( P, &P2s, P);
+	bf_multiply( Q, &Q2s, Q);
+}
+
+/*  sum one series for chunk value p.  Number of terms from
+	|p|^n / prod{ q(k)} < 2^-(32*MNTSA_SIZE + 16).
+*/
+
+static void burst_series( int type, FLOAT *p, FLOAT *sum)
+{
+	FLOAT	P, Q, T;
+	int		n, bits, lg, q;
+
+	if( bf_iszero( p))
+	{
+		bf_one( sum);
+		return;
+	}
+	n = 1;
+	bits = 0;
+	while( (bits < 32*MNTSA_SIZE + 16) && (n < BURST_MAXTERMS))
+	{
+		q = burst_q( type, n);
+		lg = 0;
+		while( q > 1)
+		{
+			q >>= 1;
+			lg++;
+		}
+		bits += lg - p->expnt;
+		n++;
+	}
+	burst_split( type, p, 0, n, &P, &Q, &T);
+	bf_divide( &T, &Q, sum);
+}
+
+/*  pull the next chunk of bits off rest.  chunk gets bits of rest
+	above 2^-(pos+len), rest keeps the remainder.
+*/
+
+static void burst_chunk( FLOAT *rest, int pos, int len, FLOAT *chunk)
+{
+	FLOAT	z;
+
+	bf_copy( rest, &z);
+	z.expnt += pos + len;
+	bf_split( &z, chunk, rest);
+	if( !bf_iszero( chunk)) chunk->expnt -= pos + len;
+	if( !bf_iszero( rest)) rest->expnt -= pos + len;
+}
+
+/*  compute y = exp(x) by bit-burst.  Meant for |x| < 1, reduce first.
+	works in place.
+*/
+
+void bf_exp_burst( FLOAT *x, FLOAT *y)
+{
+	FLOAT	rest, chunk, e;
+	int		pos, len;
+
+	bf_copy( x, &rest);
+	bf_one( y);
+	pos = 0;
+	len = BURST_START;
+	while( !bf_iszero( &rest) && (pos < 32*MNTSA_SIZE))
+	{
+		burst_chunk( &rest, pos, len, &chunk);
+		burst_series( 0, &chunk, &e);
+		bf_multiply( y, &e, y);
+		pos += len;
+		len <<= 1;
+	}
+}
+
+/*  compute s = sin(x) and c = cos(x) by bit-burst.  Meant for
+	|x| <= PI/2, reduce first.  Chunks are combined with
+	angle addition formulas.  s and c can be x but not each other.
+*/
+
+void bf_sincos_burst( FLOAT *x, FLOAT *s, FLOAT *c)
+{
+	FLOAT	rest, chunk, p, ck, sk, cs, sc, temp;
+	int		pos, len;
+
+	bf_copy( x, &rest);
+	bf_one( &cs);
+	bf_null( &sc);
+	pos = 0;
+	len = BURST_START;
+	while( !bf_iszero( &rest) && (pos < 32*MNTSA_SIZE))
+	{
+		burst_chunk( &rest, pos, len, &chunk);
+		pos += len;
+		len <<= 1;
+		if( bf_iszero( &chunk)) continue;
+		bf_multiply( &chunk, &chunk, &p);
+		bf_negate( &p);
+		burst_series( 1, &p, &ck);
+		burst_series( 2, &p, &sk);
+		bf_multiply( &chunk, &sk, &sk);
+
+/*  (cs, sc) = (cs*ck - sc*sk, sc*ck + cs*sk)  */
+
+		bf_multiply( &sc, &sk, &temp);
+		bf_multiply( &cs, &sk, &sk);
+		bf_multiply( &cs, &ck, &cs);
+		bf_subtract( &cs, &temp, &cs);
+		bf_multiply( &sc, &ck, &sc);
+		bf_add( &sc, &sk, &sc);
+	}
+	bf_copy( &sc, s);
+	bf_copy( &cs, c);
+}
+
 /*  compute 2^x for x in the range -1 ... 1.
 	Most inputs will be in range +/- .5 ... 1 but this routine could handle
 	unnormalized inputs.
@@ -404,7 +900,7 @@ void bf_polyeval( MULTIPOLY coef, FLOAT *x, FLOAT *y)
 
 void bf_twoexp( FLOAT *x, FLOAT *y)
 {
-	bf_polyeval( twoxcoef, x, y);
+	bf_chebeval( twoxcoef, x, y);
 }
 
 /*  compute cos( x) for x in range +/- PI/2
@@ -414,54 +910,270 @@ void bf_twoexp( FLOAT *x, FLOAT *y)
 
 void bf_corecos(FLOAT *x, FLOAT *y)
 {
-	FLOAT	x2;
+	FLOAT	t;
 	
-	bf_divide( x, &P2, &x2);
-	bf_multiply( &x2, &x2, &x2);
-	bf_polyeval( coscoef, &x2, y);
+	bf_multiply( x, &invP2, &t);
+	cos_halfpi( &t, coscoef, y);
 }
 
-/*  convert a float to a long.  Overflow is max
-	possible result.
+/*  y = cos( t*PI/2) for |t| <= 1.  Takes argument already scaled by
+	2/PI so reduction doesn't have to multiply back.  cs is coscoef or
+	a truncated copy of it for lower precision.
 */
 
-int	bf_float_to_int( FLOAT *f)
+static void cos_halfpi( FLOAT *t, CHEBSERIES cs, FLOAT *y)
 {
-	FLOAT	dummy, intprt;
-	int		value;
+	FLOAT	u, one;
+
+	if( MNTSA_SIZE >= BURST_MNTSA)
+	{
+		bf_multiply( t, &P2, &u);
+		bf_sincos_burst( &u, &one, y);
+		return;
+	}
+	bf_multiply( t, t, &u);
+	u.expnt++;
+	bf_one( &one);
+	bf_subtract( &u, &one, &u);		// u = 2t^2 - 1
+	bf_chebeval( cs, &u, y);
+}
+
+/*  y = sin( t*PI/2) = cos( (1 - |t|)*PI/2) with sign of t, |t| <= 1.
+	That only has absolute accuracy, small t would lose bits same as
+	its exponent.  For tiny t sin is just t*PI/2 to full precision, and
+	below 2^-(EXP_TABLE_BITS+1) u = t*PI/2 is under the exp table
+	residual, so the odd terms of expcoef give the Taylor series
+	
+		sin(u) = u*sum{ (-1)^n * u^2n/(2n+1)!}
 	
-	if( f->expnt < 1) return 0;
-	if( f->expnt > 31)
+	to full relative precision.
+*/
+
+static void sin_halfpi( FLOAT *t, CHEBSERIES cs, FLOAT *y)
+{
+	FLOAT	u, u2, sum;
+	int		signflag, n;
+
+	if( t->expnt < -16*MNTSA_SIZE)
+	{
+		bf_multiply( t, &P2, y);
+		return;
+	}
+	if( MNTSA_SIZE >= BURST_MNTSA)
 	{
-		if( f->mntsa.e[MS_MNTSA] & SIGN_BIT)
-			return SIGN_BIT;
-		return ~SIGN_BIT;
+		bf_multiply( t, &P2, &u);
+		bf_sincos_burst( &u, y, &u);
+		return;
+	}
+	if( t->expnt <= -EXP_TABLE_BITS - 1)
+	{
+		bf_multiply( t, &P2, &u);
+		bf_square( &u, &u2);
+		n = (expcoef.degree - 1) >> 1;
+		bf_copy( Address( expcoef) + 2*n + 1, &sum);
+		for( n--; n>=0; n--)
+		{
+			bf_multiply( &u2, &sum, &sum);
+			bf_subtract( Address( expcoef) + 2*n + 1, &sum, &sum);
+		}
+		bf_multiply( &u, &sum, y);
+		return;
 	}
-	bf_split( f, &intprt, &dummy);
-	if( intprt.mntsa.e[MS_MNTSA] & SIGN_BIT)
+	bf_copy( t, &u);
+	signflag = 0;
+	if( u.mntsa.e[MS_MNTSA] & SIGN_BIT)
 	{
-		bf_negate( &intprt);
-		value = -(intprt.mntsa.e[MS_MNTSA] >> ( 31 - intprt.expnt));
+		bf_negate( &u);
+		signflag = 1;
 	}
-	else	value = intprt.mntsa.e[MS_MNTSA] >> ( 31 - intprt.expnt);
-	return value;
+	bf_one( y);
+	bf_subtract( y, &u, &u);
+	cos_halfpi( &u, cs, y);
+	if( signflag) bf_negate( y);
 }
-	
+
+/*  get 32 bits of a little endian word array starting at bit pos.
+	Bits outside the array are zero.
+*/
+
+static ELEMENT ph_bits( ELEMENT *r, int size, int pos)
+{
+	int		word, shift;
+	ELEMENT	lo, hi;
+
+	word = pos >> 5;
+	shift = pos & 31;
+	lo = ((word >= 0) && (word < size)) ? r[word] : 0;
+	hi = ((word+1 >= 0) && (word+1 < size)) ? r[word+1] : 0;
+	if( !shift) return lo;
+	return (lo >> shift) | (hi << (32 - shift));
+}
+
+/*  Payne-Hanek reduction.  |x| = M*2^s with M the mantissa as an
+	integer and s = expnt - (32*MNTSA_SIZE - 1).  Words of 2/PI whose
+	product with M is a multiple of 4 are skipped, then M times the
+	next few words gives x*2/PI mod 4 with 32*MNTSA_SIZE + PH_GUARD
+	fraction bits, all in integer arithmetic.  Guard bits cover
+	cancellation when x is close to a multiple of PI/2.
+	Enter with 0 < expnt <= PH_MAXEXP.  Returns n mod 4 and
+	t in [0, 1) with x*2/PI = n + t.  Everything is truncated, so |t|
+	is below the exact fraction by less than one ulp of t plus
+	2^-(32*MNTSA_SIZE + PH_GUARD) for the 2/PI words left off.
+*/
+
+int bf_ph_reduce( FLOAT *x, FLOAT *t)
+{
+	ELEMENT		m[MNTSA_SIZE], r[PH_SIZE + MNTSA_SIZE];
+	FLOAT		ax;
+	int			i, j, k0, n, q, b, s, quad, signflag;
+	unsigned long long	prod, carry;
+
+	bf_copy( x, &ax);
+	signflag = 0;
+	if( ax.mntsa.e[MS_MNTSA] & SIGN_BIT)
+	{
+		bf_negate( &ax);
+		signflag = 1;
+	}
+	OPLOOP(i) m[i] = ax.mntsa.e[i];
+	s = ax.expnt - (32*MNTSA_SIZE - 1);
+
+/*  window of 2/PI words k0 ... k0+n-1 as a little endian integer  */
+
+	k0 = (ax.expnt - 32*MNTSA_SIZE - 1)/32;
+	if( k0 < 0) k0 = 0;
+	n = (ax.expnt + 32*MNTSA_SIZE + PH_GUARD + 31)/32 - k0;
+	if( n > PH_SIZE) n = PH_SIZE;
+
+/*  r = m * window, schoolbook with 64 bit products  */
+
+	for( i=0; i<n+MNTSA_SIZE; i++) r[i] = 0;
+	for( i=0; i<MNTSA_SIZE; i++)
+	{
+		carry = 0;
+		for( j=0; j<n; j++)
+		{
+			prod = (unsigned long long)m[i] *
+					(unsigned long long)two_over_pi[k0 + n - 1 - j] +
+					(unsigned long long)r[i+j] + carry;
+			r[i+j] = prod & 0xffffffff;
+			carry = prod >> 32;
+		}
+		r[i+n] = carry;
+	}
+
+/*  binary point of product is at bit q  */
+
+	q = 32*(k0 + n) - s;
+	quad = ph_bits( r, n + MNTSA_SIZE, q) & 3;
+
+/*  find leading fraction bit and pack into t  */
+
+	for( b=q-1; b>=0; b--)
+		if( (r[b >> 5] >> (b & 31)) & 1) break;
+	bf_null( t);
+	if( b >= 0)
+	{
+		for( i=0; i<MNTSA_SIZE; i++)
+			t->mntsa.e[MS_MNTSA - i] = ph_bits( r, n + MNTSA_SIZE, b - 30 - 32*i);
+		t->mntsa.e[MS_MNTSA] &= ~SIGN_BIT;
+		t->expnt = b - q + 1;
+	}
+	if( signflag)
+	{
+		bf_negate( t);
+		quad = -quad;
+	}
+	return quad & 3;
+}
+
+/*  x = 2/PI from the leading bits of the table, truncated, so x is
+	below 2/PI by less than 2^-(32*MNTSA_SIZE - 1).  Lets ball
+	arithmetic build an enclosure of PI/2.
+*/
+
+void bf_two_over_pi( FLOAT *x)
+{
+	int		i;
+
+	x->expnt = 0;
+	x->mntsa.e[MS_MNTSA] = two_over_pi[0] >> 1;
+	for( i=1; i<MNTSA_SIZE; i++)
+		x->mntsa.e[MS_MNTSA - i] = ((two_over_pi[i - 1] << 31) |
+				(two_over_pi[i] >> 1)) & 0xffffffff;
+}
+
+/*  reduce x for trig functions.
+	x*2/PI = n + t with |t| <= 1/2, so x = (n + t)*PI/2.
+	Small x multiplies by cached 2/PI.  Larger x uses Payne-Hanek
+	so the result is good to full precision for |x| < 2^PH_MAXEXP.
+	Beyond that we fall back to the multiply and t is garbage.
+	Returns n mod 4 and t.
+*/
+
+static int bf_trig_reduce( FLOAT *x, FLOAT *t)
+{
+	FLOAT	z, half;
+	int		quad;
+
+	if( (x->expnt > 0) && (x->expnt <= PH_MAXEXP) && !bf_iszero( x))
+		quad = bf_ph_reduce( x, t);
+	else
+	{
+		bf_multiply( x, &invP2, &z);
+		if( z.expnt > 0) quad = bf_nearest_frac( &z, t);
+		else
+		{
+			bf_copy( &z, t);
+			quad = 0;
+		}
+	}
+	bf_one( &half);
+	half.expnt--;
+	if( !bf_iszero( t) && (bf_compare( t, &half) > 0))
+	{
+		half.expnt++;
+		if( t->mntsa.e[MS_MNTSA] & SIGN_BIT)
+		{
+			bf_add( t, &half, t);
+			quad--;
+		}
+		else
+		{
+			bf_subtract( t, &half, t);
+			quad++;
+		}
+	}
+	return quad & 3;
+}
+
 /*  compute e^x for any x.  |x| > 2^32/ln(2) will overflow
 	and return max possible value and 0.
 	Otherwise returns y = exp(x) and 1.
 	works in place.
+	Table driven (Tang's method):  x/ln(2) = n + j/2^k + r with
+	0 <= r < 2^-k, then e^x = 2^n * exptable[j] * exp(r*ln(2)) and the
+	last factor is a short Taylor series.
 */
 
 int bf_exp( FLOAT *x, FLOAT *y)
 {
-	FLOAT	z, xp;
+	return exp_core( x, expcoef, y);
+}
+
+/*  body of bf_exp.  poly is expcoef or a truncated copy of it
+	for lower precision.
+*/
+
+static int exp_core( FLOAT *x, MULTIPOLY poly, FLOAT *y)
+{
+	FLOAT	z, xp, s, *tptr;
 	long		xpnt;
-	INDEX	i;
+	INDEX	i, j;
 	
 /*  convert to base 2  */
 
-	bf_divide( x, &ln2, &z);
+	bf_multiply( x, &invln2, &z);
 	
 /*  check range is possible to do  */
 
@@ -478,11 +1190,27 @@ int bf_exp( FLOAT *x, FLOAT *y)
 		return 0;
 	}
 	
-/*  we can perform operation, send z mods 2 to core */
+/*  split off integer part and force fraction positive  */
 
 	bf_split(&z, &xp, &z);
 	xpnt = bf_float_to_int( &xp);
-	bf_twoexp( &z, y);
+	if( z.mntsa.e[MS_MNTSA] & SIGN_BIT)
+	{
+		bf_one( &xp);
+		bf_add( &z, &xp, &z);
+		xpnt--;
+	}
+
+/*  top k bits of fraction index table, rest is residual  */
+
+	z.expnt += EXP_TABLE_BITS;
+	bf_split( &z, &xp, &z);
+	j = bf_float_to_int( &xp);
+	z.expnt -= EXP_TABLE_BITS;
+	bf_multiply( &z, &ln2, &s);
+	bf_polyeval( poly, &s, &s);
+	tptr = Address( exptable) + j;
+	bf_multiply( tptr, &s, y);
 	
 /*  next add xpnt to exponent of y  */
 
@@ -490,150 +1218,678 @@ int bf_exp( FLOAT *x, FLOAT *y)
 	return 1;
 }
 
-/*  split a FLOAT into its integer and fractional parts  */
+/*  compute natural log of x using the exp tables.
+	x = 2^e * m with 1 <= m < 2.  Find table entry exptable[j] <= m,
+	then m/exptable[j] = 1 + u with u < 2^-k and
+	
+		log(x) = (e + j/2^k)*ln(2) + 2*atanh(u/(2+u))
+	
+	1/exptable[j] = exptable[2^k - j]/2 so there is only one divide.
+	Returns 0 if x <= 0 (y untouched), otherwise y = log(x) and 1.
+	works in place.
+*/
 
-void bf_split( FLOAT *x, FLOAT *intprt, FLOAT *frac)
+int bf_log( FLOAT *x, FLOAT *y)
 {
-	FLOAT	fracpart;
-	INDEX	i, signflag;
-	ELEMENT	mask, xpchk;
+	FLOAT	m, u, w, w2, temp, *tptr;
+	long	e;
+	INDEX	lo, hi, mid, j, size;
 
-/*  if number < 1, return just a fraction  */
-	
-	if( x->expnt <= 0)
+	if( bf_iszero( x) || (x->mntsa.e[MS_MNTSA] & SIGN_BIT)) return 0;
+	if( (MNTSA_SIZE >= AGM_MNTSA) && ((x->expnt < 0) || (x->expnt > 1)))
+		return bf_log_agm( x, y);
+	size = 1 << EXP_TABLE_BITS;
+	bf_copy( x, &m);
+	e = m.expnt - 1;
+	m.expnt = 1;
+
+/*  binary search for largest table entry <= m  */
+
+	lo = 0;
+	hi = size;
+	while( hi - lo > 1)
 	{
-		bf_null( intprt);
-		bf_copy( x, frac);
-		return;
+		mid = (lo + hi) >> 1;
+		tptr = Address( exptable) + mid;
+		if( bf_compare( tptr, &m) > 0) hi = mid;
+		else lo = mid;
 	}
+	j = lo;
 
-/*  zero out 31 bits of ms word, then one block at a time */
+/*  u = m/exptable[j] - 1,  w = u/(2+u)  */
 
-	bf_copy( x, &fracpart);
-	signflag = 0;
-	if( fracpart.mntsa.e[MS_MNTSA] & SIGN_BIT)
+	if( j)
 	{
-		bf_negate( &fracpart);
-		signflag = 1;
+		tptr = Address( exptable) + size - j;
+		bf_multiply( &m, tptr, &u);
+		u.expnt--;
+	}
+	else bf_copy( &m, &u);
+	bf_one( &temp);
+	bf_subtract( &u, &temp, &u);
+	temp.expnt++;
+	bf_add( &u, &temp, &temp);
+	bf_divide( &u, &temp, &w);
+	bf_multiply( &w, &w, &w2);
+	bf_polyeval( logcoef, &w2, &temp);
+	bf_multiply( &w, &temp, &w);
+	w.expnt++;
+
+/*  add in (e + j/2^k)*ln(2)  */
+
+	bf_int_to_float( j, &temp);
+	temp.expnt -= EXP_TABLE_BITS;
+	bf_int_to_float( e, &u);
+	bf_add( &u, &temp, &temp);
+	bf_multiply( &temp, &ln2, &temp);
+	bf_add( &temp, &w, y);
+	return 1;
+}
+
+/*  compute y = log(1 + u) without losing the bits of small u.
+	For |u| < 2^-(EXP_TABLE_BITS+1) this is the j = 0 case of bf_log
+	with u given directly, 2*atanh(u/(2+u)).  Otherwise 1 + u is
+	exact enough and bf_log does the rest.
+	Returns 0 if u <= -1 (y untouched), 1 otherwise.  works in place.
+*/
+
+int bf_log1p( FLOAT *u, FLOAT *y)
+{
+	FLOAT	w, w2, temp;
+
+	if( bf_iszero( u))
+	{
+		bf_null( y);
+		return 1;
 	}
-	i = MS_MNTSA;
-	xpchk = fracpart.expnt;
-	if( xpchk > 31)
+	if( u->expnt > -EXP_TABLE_BITS - 1)
 	{
-		fracpart.mntsa.e[i] = 0;
-		i--;
-		xpchk -= 31;
+		bf_one( &temp);
+		bf_add( u, &temp, &temp);
+		return bf_log( &temp, y);
 	}
-	while( (xpchk > 32) && ( i>0 ))
+	bf_one( &temp);
+	temp.expnt++;
+	bf_add( u, &temp, &temp);
+	bf_divide( u, &temp, &w);
+	bf_multiply( &w, &w, &w2);
+	bf_polyeval( logcoef, &w2, &temp);
+	bf_multiply( &w, &temp, y);
+	y->expnt++;
+	return 1;
+}
+
+/*  arithmetic-geometric mean of a and b, both positive.
+	a = (a+b)/2, b = sqrt(a*b) until they agree to full precision,
+	which takes about log_2(bits) steps.  m can be a or b.
+*/
+
+void bf_agm( FLOAT *a, FLOAT *b, FLOAT *m)
+{
+	FLOAT	x, y, an, d;
+	int		i;
+
+	bf_copy( a, &x);
+	bf_copy( b, &y);
+	for( i=0; i<AGM_LOOPS; i++)
 	{
-		fracpart.mntsa.e[i] = 0;
-		i--;
-		xpchk -= 32;
+		bf_add( &x, &y, &an);
+		an.expnt--;
+		bf_subtract( &x, &y, &d);
+		bf_multiply( &x, &y, &y);
+		bf_square_root( &y, &y);
+		bf_copy( &an, &x);
+		if( bf_iszero( &d) || (d.expnt < x.expnt - 16*MNTSA_SIZE)) break;
 	}
 
-/*  next zero out the remaining integer bits in a left over word  */
+/*  once a - b < 2^-(bits/2) the next mean is exact to full precision  */
 
-	if( i != MS_MNTSA) mask = ~0UL >> xpchk;
-	else 	mask = ( ~0UL >> (xpchk+1));
-	fracpart.mntsa.e[i] &= mask;
-	if( signflag) bf_negate( &fracpart);
-	bf_normal( &fracpart);
-	bf_subtract( x, &fracpart, intprt);
-	bf_copy( &fracpart, frac);
+	bf_add( &x, &y, m);
+	m->expnt--;
+}
+
+/*  compute natural log with the AGM:
+		ln(s) = PI/(2*AGM(1, 4/s)) + O(1/s^2)
+	with s = x*2^m scaled up to about 2^(bits/2), then
+	ln(x) = ln(s) - m*ln(2).  Costs a few dozen full multiplies
+	and square roots at any precision.  Loses up to log_2(ln(s)/ln(x))
+	bits to cancellation, so bf_log only uses it for x outside 1/2 ... 2.
+	returns 0 if x <= 0, 1 otherwise.
+*/
+
+int bf_log_agm( FLOAT *x, FLOAT *y)
+{
+	FLOAT	s, one, temp;
+	long	m;
+
+	if( bf_iszero( x) || (x->mntsa.e[MS_MNTSA] & SIGN_BIT)) return 0;
+	bf_copy( x, &s);
+	s.expnt = 16*MNTSA_SIZE + 8;
+	m = s.expnt - x->expnt;
+	bf_reciprical( &s, &s);
+	s.expnt += 2;
+	bf_one( &one);
+	bf_agm( &one, &s, &s);
+	s.expnt++;
+	bf_copy( &P2, &temp);
+	temp.expnt++;
+	bf_divide( &temp, &s, &s);
+	bf_int_to_float( m, &temp);
+	bf_multiply( &temp, &ln2, &temp);
+	bf_subtract( &s, &temp, y);
+	return 1;
+}
+
+/*  log base 2 and base 10.  returns 0 if x <= 0, 1 otherwise.  */
+
+int bf_log2( FLOAT *x, FLOAT *y)
+{
+	if( !bf_log( x, y)) return 0;
+	bf_multiply( y, &invln2, y);
+	return 1;
+}
+
+int bf_log10( FLOAT *x, FLOAT *y)
+{
+	if( !bf_log( x, y)) return 0;
+	bf_multiply( y, &invln10, y);
+	return 1;
 }
 
 /*  compute cosine(x) for any x.
-	x values larger than PI*2^200 will be in gross error, so watch out!
+	x values larger than 2^PH_MAXEXP will be in gross error, so watch out!
 	works in place, returns y = cos(x)
 */
 
 void bf_cosine( FLOAT *x, FLOAT *y)
 {
-	FLOAT	z, PI, dummy, PI3;
-	int		cmpr;
+	cosine_core( x, coscoef, y);
+}
+
+static void cosine_core( FLOAT *x, CHEBSERIES cs, FLOAT *y)
+{
+	FLOAT	t;
+	int		quad;
+	
+	quad = bf_trig_reduce( x, &t);
+	if( quad & 1) sin_halfpi( &t, cs, y);
+	else cos_halfpi( &t, cs, y);
+	if( (quad == 1) || (quad == 2)) bf_negate( y);
+}
+
+/*  compute sine(x) for any x.
+	same as cosine, jus move arguments around.
+	works in place, 
+	returns y = sin(x)
+*/
+
+void bf_sine( FLOAT *x, FLOAT *y)
+{
+	sine_core( x, coscoef, y);
+}
+
+static void sine_core( FLOAT *x, CHEBSERIES cs, FLOAT *y)
+{
+	FLOAT	t;
+	int		quad;
 	
-/*  create 2*PI  */
+	quad = bf_trig_reduce( x, &t);
+	if( quad & 1) cos_halfpi( &t, cs, y);
+	else sin_halfpi( &t, cs, y);
+	if( quad & 2) bf_negate( y);
+}
 
-	bf_copy( &P2, &PI);
-	PI.expnt += 2;
+/*  compute sine and cosine of x together.  Argument reduction is
+	done once and both results come from the same reduced value.
+	s and c can be the same as x, but not each other.
+*/
 
-/*  check range of input and force modulo 2PI operation  */
+void bf_sincos( FLOAT *x, FLOAT *s, FLOAT *c)
+{
+	FLOAT	t, st, ct;
+	int		quad;
 
-	cmpr = bf_compare( x, &PI);
-	if( cmpr > 0 )
+	quad = bf_trig_reduce( x, &t);
+	if( MNTSA_SIZE >= BURST_MNTSA)
 	{
-		bf_divide( x, &PI, &z);
-		bf_split( &z, &dummy, &z);
-		bf_multiply( &PI, &z, &z);
+		bf_multiply( &t, &P2, &t);
+		bf_sincos_burst( &t, &st, &ct);
 	}
-	else bf_copy( x, &z);
-	if( z.mntsa.e[MS_MNTSA] & SIGN_BIT) bf_negate( &z);
+	else
+	{
+		sin_halfpi( &t, coscoef, &st);
+		cos_halfpi( &t, coscoef, &ct);
+	}
+	if( quad & 1)
+	{
+		bf_copy( &ct, s);
+		bf_copy( &st, c);
+	}
+	else
+	{
+		bf_copy( &st, s);
+		bf_copy( &ct, c);
+	}
+	if( quad & 2) bf_negate( s);
+	if( (quad == 1) || (quad == 2)) bf_negate( c);
+}
 
-/*  z is now in range 0...2PI.  Now convert to range of core cos */
+/*  Reduced accuracy versions.  bf_exp_bits, bf_cosine_bits and
+	bf_sine_bits give about bits correct bits.  Series are cut to the
+	lowest degree that reaches bits, multiplies and Newton steps only
+	work on the top bf_work_limbs words of each mantissa, so the cost
+	drops with the accuracy asked for.  Large arguments lose bits in
+	reduction same as the full versions.
+*/
+
+/*  smallest degree of the 1/n! series with truncation error below
+	2^-(bits+2) for a table residual |s| < ln(2)/2^EXP_TABLE_BITS.
+*/
+
+static int exp_degree( int bits)
+{
+	int		n, err, q;
 
-	cmpr = bf_compare( &z, &P2);
-	if( cmpr <= 0)
+	n = 0;
+	err = 0;
+	while( (err < bits + 2) && (n < expcoef.degree))
 	{
-		bf_corecos( &z, y);
-		return;
+		n++;
+		q = n;
+		while( q > 1)
+		{
+			err++;
+			q >>= 1;
+		}
+		err += EXP_TABLE_BITS;
 	}
-	PI.expnt--;
-	bf_add( &PI, &P2, &PI3);	// 3 PI/2
-	cmpr = bf_compare( &z, &PI3);
-	if( cmpr > 0)
+	return n;
+}
+
+/*  lowest degree of a Chebyshev series with all dropped coefficients
+	below 2^-(bits+2).  They fall off geometrically, so the sum of
+	what is dropped is below 2^-(bits+1).
+*/
+
+static int cheb_degree( CHEBSERIES cs, int bits)
+{
+	FLOAT	*cof;
+	int		k;
+
+	for( k=cs.degree; k>0; k--)
 	{
-		PI.expnt++;
-		bf_subtract( &PI, &z, &z);	// 2PI - x
-		bf_corecos( &z, y);
-		return;
+		cof = Address( cs) + k;
+		if( !bf_iszero( cof) && (cof->expnt >= -bits - 2)) break;
 	}
-	bf_subtract( &PI, &z, &z);	// PI - x
-	bf_corecos( &z, y);
-	bf_negate( y);
+	return k;
 }
 
-/*  compute sine(x) for any x.
-	same as cosine, jus move arguments around.
-	works in place, 
-	returns y = sin(x)
+/*  series for 2^x or cos to 2^-bits.  The full series cut down with
+	cheb_degree, or the minimax one from bf_init_minimax if that is
+	good to 2^-(bits+1) too and shorter.
 */
 
-void bf_sine( FLOAT *x, FLOAT *y)
+static CHEBSERIES short_series( CHEBSERIES full, CHEBSERIES mini, int bits)
 {
-	FLOAT	z, PI, dummy;
-	int		cmpr, signflag;
-	
-/*  create 2*PI and reduce x modulo 2PI signed  */
+	CHEBSERIES	cs;
+
+	cs.memdex = full.memdex;
+	cs.degree = cheb_degree( full, bits);
+	if( (minibits > bits) && (mini.degree < cs.degree)) return mini;
+	return cs;
+}
+
+/*  number of mantissa words needed for bits good bits after
+	ZIV_LOSS bits of rounding in the arithmetic.
+*/
+
+static int bits_limbs( int bits)
+{
+	int		limbs;
+
+	limbs = (bits + 2 + ZIV_LOSS + 31)/32;
+	if( limbs < 2) limbs = 2;
+	if( limbs > MNTSA_SIZE) limbs = MNTSA_SIZE;
+	return limbs;
+}
+
+/*  y = exp(x) to relative error 2^-bits.  Returns same as bf_exp.  */
+
+int bf_exp_bits( FLOAT *x, int bits, FLOAT *y)
+{
+	MULTIPOLY	poly;
+	int			save, rtn;
+
+	poly.memdex = expcoef.memdex;
+	poly.degree = exp_degree( bits);
+	save = bf_work_limbs;
+	bf_work_limbs = bits_limbs( bits);
+	rtn = exp_core( x, poly, y);
+	bf_work_limbs = save;
+	return rtn;
+}
+
+/*  y = 2^x for |x| <= 1 to error 2^-bits, see bf_twoexp.  */
+
+void bf_twoexp_bits( FLOAT *x, int bits, FLOAT *y)
+{
+	CHEBSERIES	cs;
+	int			save;
+
+	cs = short_series( twoxcoef, minitwox, bits);
+	save = bf_work_limbs;
+	bf_work_limbs = bits_limbs( bits);
+	bf_chebeval( cs, x, y);
+	bf_work_limbs = save;
+}
+
+/*  y = cos(x) or sin(x) to absolute error 2^-bits.  */
+
+void bf_cosine_bits( FLOAT *x, int bits, FLOAT *y)
+{
+	CHEBSERIES	cs;
+	int			save;
+
+	cs = short_series( coscoef, minicos, bits);
+	save = bf_work_limbs;
+	bf_work_limbs = bits_limbs( bits);
+	cosine_core( x, cs, y);
+	bf_work_limbs = save;
+}
+
+void bf_sine_bits( FLOAT *x, int bits, FLOAT *y)
+{
+	CHEBSERIES	cs;
+	int			save;
+
+	cs = short_series( coscoef, minicos, bits);
+	save = bf_work_limbs;
+	bf_work_limbs = bits_limbs( bits);
+	sine_core( x, cs, y);
+	bf_work_limbs = save;
+}
+
+/*  a = atan2(y, x), the angle of the point (x, y) with
+	-PI < a <= PI.  Folded so 0 <= y <= x, the angle is then at most
+	PI/4 and w(15 + 4w^2)/(15 + 9w^2) with w = y/x is good to 6 bits.
+	Each step
 
-	bf_copy( &P2, &PI);
-	PI.expnt += 2;
-	cmpr = bf_compare( x, &PI);
-	if( cmpr > 0)
+		a = a + (y*cos(a) - x*sin(a))/(x*cos(a) + y*sin(a))
+
+	is a + tan(atan2(y, x) - a), which leaves an error of e^3/3 so it
+	triples the good bits.  All steps but the last are done with the
+	reduced precision sine and cosine.  Below 2^-(EXP_TABLE_BITS+1) the
+	atanh series of bf_log does it directly with alternating signs.
+	returns 0 if x = y = 0 (a is set to 0), 1 otherwise.
+*/
+
+int bf_atan2( FLOAT *y, FLOAT *x, FLOAT *a)
+{
+	FLOAT	ax, ay, t, top, bottom, s, c;
+	int		xneg, yneg, swap, good, prec, full, save;
+
+	if( bf_iszero( x) && bf_iszero( y))
 	{
-		bf_divide( x, &PI, &z);
-		bf_split( &z, &dummy, &z);
-		bf_multiply( &PI, &z, &z);
+		bf_null( a);
+		return 0;
 	}
-	else bf_copy( x, &z);
-	if( z.mntsa.e[MS_MNTSA] & SIGN_BIT)
+	xneg = (x->mntsa.e[MS_MNTSA] & SIGN_BIT) ? 1 : 0;
+	yneg = (y->mntsa.e[MS_MNTSA] & SIGN_BIT) ? 1 : 0;
+	bf_copy( x, &ax);
+	bf_copy( y, &ay);
+	if( xneg) bf_negate( &ax);
+	if( yneg) bf_negate( &ay);
+	swap = 0;
+	if( bf_iszero( &ax) || (!bf_iszero( &ay) && (bf_compare( &ay, &ax) > 0)))
 	{
-		bf_negate( &z);
-		signflag = 1;
+		bf_copy( &ax, &t);
+		bf_copy( &ay, &ax);
+		bf_copy( &t, &ay);
+		swap = 1;
+	}
+	bf_divide( &ay, &ax, &t);
+	if( !bf_iszero( &t) && (t.expnt < -EXP_TABLE_BITS))
+	{
+
+/*  small angles would only get absolute accuracy from sine,
+	use atan(w) = w*sum{ (-w^2)^n/(2n+1)} instead.
+*/
+
+		bf_square( &t, &s);
+		bf_negate( &s);
+		bf_polyeval( logcoef, &s, &s);
+		bf_multiply( &t, &s, &t);
+	}
+	else if( !bf_iszero( &t))
+	{
+
+/*  first guess at low precision  */
+
+		save = bf_work_limbs;
+		bf_work_limbs = bits_limbs( 16);
+		bf_square( &t, &s);
+		bf_int_to_float( 4, &c);
+		bf_multiply( &s, &c, &top);
+		bf_int_to_float( 9, &c);
+		bf_multiply( &s, &c, &bottom);
+		bf_int_to_float( 15, &c);
+		bf_add( &top, &c, &top);
+		bf_add( &bottom, &c, &bottom);
+		bf_multiply( &t, &top, &t);
+		bf_divide( &t, &bottom, &t);
+		bf_work_limbs = save;
+
+/*  Newton steps, last one at full length  */
+
+		full = 32*MNTSA_SIZE - ZIV_LOSS;
+		good = 6;
+		while( good < full)
+		{
+			prec = 3*good;
+			if( prec >= full)
+			{
+				prec = full;
+				bf_sincos( &t, &s, &c);
+			}
+			else
+			{
+				bf_sine_bits( &t, prec, &s);
+				bf_cosine_bits( &t, prec, &c);
+				bf_work_limbs = bits_limbs( prec);
+			}
+			bf_multiply( &ay, &c, &top);
+			bf_multiply( &ax, &s, &bottom);
+			bf_subtract( &top, &bottom, &top);
+			bf_multiply( &ax, &c, &bottom);
+			bf_multiply( &ay, &s, &s);
+			bf_add( &bottom, &s, &bottom);
+			bf_divide( &top, &bottom, &top);
+			bf_add( &t, &top, &t);
+			bf_work_limbs = save;
+			good = prec;
+		}
+	}
+
+/*  unfold  */
+
+	if( swap) bf_subtract( &P2, &t, &t);
+	if( xneg)
+	{
+		bf_copy( &P2, &c);
+		c.expnt++;
+		bf_subtract( &c, &t, &t);
+	}
+	if( yneg) bf_negate( &t);
+	bf_copy( &t, a);
+	return 1;
+}
+
+/*  Adaptive precision.  Each function is first evaluated with
+	bf_exp_bits etc. at a target of bits plus ZIV_GUARD, and an error
+	bound for that result is worked out.  If the bound shows the result
+	rounds the same way as the true value, it is rounded to bits and
+	returned.  If not, the working precision doubles and it tries again,
+	up to the full mantissa.  Error bounds count the cut down series and
+	arithmetic, ZIV_LOSS bits of rounding at full length, and bits lost
+	reducing large arguments.  ZIV_LOSS is what the cores have been
+	measured to lose, not a proved bound, so the rounding is only as
+	good as that assumption.  bf_ball_exp and the other ball functions
+	give enclosures that are proved, at more cost.
+*/
+
+/*  get bit k below the leading bit of a normalized magnitude  */
+
+static int lead_bit( FLOAT *m, int k)
+{
+	int		pos;
+
+	pos = 32*MNTSA_SIZE - 2 - k;
+	if( pos < 0) return 0;
+	return (m->mntsa.e[pos >> 5] >> (pos & 31)) & 1;
+}
+
+/*  check if y, known to relative error 2^-err, rounds to the same
+	bits bit number as the exact value it approximates.  That fails
+	only when the bits past the rounding point up to err are all
+	the same, meaning a rounding boundary is within the error.
+	returns 1 if it can be rounded, 0 if not.
+*/
+
+int bf_can_round( FLOAT *y, int err, int bits)
+{
+	FLOAT	m;
+	int		k, first;
+
+	if( bf_iszero( y)) return 1;
+	if( err > 32*MNTSA_SIZE - 2) err = 32*MNTSA_SIZE - 2;
+	if( err <= bits + 1) return 0;
+	bf_copy( y, &m);
+	if( m.mntsa.e[MS_MNTSA] & SIGN_BIT) bf_negate( &m);
+	first = lead_bit( &m, bits + 1);
+	for( k=bits+2; k<err; k++)
+		if( lead_bit( &m, k) != first) return 1;
+	return 0;
+}
+
+/*  round a to bits significant bits, nearest with ties up.
+	bits must be less than 32*MNTSA_SIZE - 2.  works in place.
+*/
+
+void bf_round_bits( FLOAT *a, int bits, FLOAT *b)
+{
+	FLOAT	z;
+	long	shift;
+
+	if( bf_iszero( a))
+	{
+		bf_null( b);
+		return;
+	}
+	bf_copy( a, &z);
+	shift = z.expnt - bits;
+	z.expnt = bits;
+	bf_round( &z, b);
+	b->expnt += shift;
+}
+
+/*  y = exp(x) rounded to bits, correctly as long as the cores stay
+	within ZIV_LOSS, see above.  Returns 1 if the error estimate
+	decided the rounding, 0 if full precision was not enough to decide
+	or x is out of range, y then holds the best full precision value.
+*/
+
+int bf_exp_ziv( FLOAT *x, int bits, FLOAT *y)
+{
+	FLOAT		z;
+	int			prec, err, loss, full;
+
+	bf_multiply( x, &invln2, &z);
+	loss = (z.expnt > 0) ? z.expnt : 0;
+	prec = bits + ZIV_GUARD;
+	while( 1)
+	{
+		full = (prec >= 32*MNTSA_SIZE - ZIV_LOSS);
+		if( full)
+		{
+			if( !bf_exp( x, &z))
+			{
+				bf_copy( &z, y);
+				return 0;
+			}
+			err = 32*MNTSA_SIZE - ZIV_LOSS - loss;
+		}
+		else
+		{
+			bf_exp_bits( x, prec, &z);
+			err = prec - 1 - loss;
+		}
+		if( bf_can_round( &z, err, bits))
+		{
+			bf_round_bits( &z, bits, y);
+			return 1;
+		}
+		if( full)
+		{
+			bf_copy( &z, y);
+			return 0;
+		}
+		prec <<= 1;
 	}
-	else signflag = 0;
+}
 
-/*  z is no in range 0... 2*PI.
-	if bigger than PI, flip sign of result and fold back to 0..PI,
-	then subtract PI/2 to put into corecos range.
+/*  common Ziv loop for sine and cosine.  Errors are absolute,
+	so the relative bound shrinks with the exponent of the result.
+	Bit-burst cores don't cut down, so they go straight to full.
 */
-	PI.expnt--;
-	cmpr = bf_compare( &z, &PI);
-	if( cmpr > 0)
+
+static int trig_ziv( FLOAT *x, int bits, FLOAT *y, int sineflag)
+{
+	FLOAT		z;
+	int			prec, err, loss, full;
+
+	loss = 0;
+	if( x->expnt > PH_MAXEXP) loss = x->expnt;
+	prec = bits + ZIV_GUARD;
+	while( 1)
 	{
-		signflag ^= 1;
-		bf_subtract( &z, &PI, &z);
+		full = (prec >= 32*MNTSA_SIZE - ZIV_LOSS) || (MNTSA_SIZE >= BURST_MNTSA);
+		if( full)
+		{
+			if( sineflag) bf_sine( x, &z);
+			else bf_cosine( x, &z);
+			err = 32*MNTSA_SIZE - ZIV_LOSS - loss;
+		}
+		else
+		{
+			if( sineflag) bf_sine_bits( x, prec, &z);
+			else bf_cosine_bits( x, prec, &z);
+			err = prec - 1 - loss;
+		}
+		if( !bf_iszero( &z)) err += z.expnt - 1;
+		if( bf_can_round( &z, err, bits))
+		{
+			bf_round_bits( &z, bits, y);
+			return 1;
+		}
+		if( full)
+		{
+			bf_copy( &z, y);
+			return 0;
+		}
+		prec <<= 1;
 	}
-	bf_subtract( &z, &P2, &z);
-	bf_corecos( &z, y);
-	if( signflag) bf_negate(y);
+}
+
+/*  y = cos(x) or sin(x) rounded to bits, on the same terms and with
+	the same returns as bf_exp_ziv.
+*/
+
+int bf_cosine_ziv( FLOAT *x, int bits, FLOAT *y)
+{
+	return trig_ziv( x, bits, y, 0);
+}
+
+int bf_sine_ziv( FLOAT *x, int bits, FLOAT *y)
+{
+	return trig_ziv( x, bits, y, 1);
 }
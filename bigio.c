@@ -280,13 +280,11 @@ void bf_float_to_ascii( FLOAT *numbr, char *outstring)
 char bf_digitof( FLOAT *frac)
 {
 	char num;
-	unsigned long mask;
 	long xp2 = 31 - frac->expnt;
 	
 	if ( xp2 > 30 ) return '0';
-	mask = ~0 << xp2;
-	num = (( mask & frac->mntsa.e[MS_MNTSA]) >> xp2);
-	frac->mntsa.e[MS_MNTSA] &= ~mask;
+	num = frac->mntsa.e[MS_MNTSA] >> xp2;
+	frac->mntsa.e[MS_MNTSA] &= (1UL << xp2) - 1;
 	bf_normal( frac);
 	return num | '0';
 }
@@ -0,0 +1,603 @@
+/*  Remez exchange algorithm for minimax approximations.
+	Approximations are built as Chebyshev series in t = (2x - a - b)/(b - a)
+	for x in [a, b], evaluate with bf_chebeval.  The Chebyshev basis keeps
+	the linear equations well conditioned where a power series Vandermonde
+	matrix would eat 50+ bits at degree 40.
+	The function being approximated has to be computed to several more
+	bits than the target error or the alternation can't be found.  Tables
+	for full precision should be generated with a larger MNTSA_SIZE and
+	written out with bf_print_series.
+	Algorithm follows Computer Approximations chapter 3.
+*/
+
+#include <stdio.h>
+#include "bigfloat.h"
+#include "multipoly.h"
+
+extern RAMDATA ram_block[];
+extern CHEBSERIES	twoxcoef;
+extern CHEBSERIES	coscoef;
+extern CHEBSERIES	minitwox;
+extern CHEBSERIES	minicos;
+extern int			minibits;
+extern FLOAT		P2;
+
+#define	REMEZ_LOOPS		12	/*  maximum number of exchanges  */
+#define	SEARCH_LOOPS	32	/*  bisection and golden section steps  */
+#define	REMEZ_TOL		4	/*  stop when error levelled to 2^-REMEZ_TOL  */
+#define	MINIMAX_GUARD	24	/*  bits reference function must exceed target  */
+
+/*  bf_compare goes by exponent first, which is wrong when one side
+	is zero.  Returns 1 if |a| > |b|, 0 otherwise.
+*/
+
+static int remez_bigger( FLOAT *a, FLOAT *b)
+{
+	if( bf_iszero( a)) return 0;
+	if( bf_iszero( b)) return 1;
+	return bf_compare( a, b) > 0;
+}
+
+/*  map t in [-1, 1] to x = mid + half*t  */
+
+static void remez_map( FLOAT *mid, FLOAT *half, FLOAT *t, FLOAT *x)
+{
+	FLOAT	temp;
+
+	bf_multiply( half, t, &temp);
+	bf_add( mid, &temp, x);
+}
+
+/*  compute error of approximation e = f(x) - p(t) at t  */
+
+static void remez_error( BF_FUNC f, CHEBSERIES p, FLOAT *mid, FLOAT *half,
+				FLOAT *t, FLOAT *e)
+{
+	FLOAT	x, fx, px;
+
+	remez_map( mid, half, t, &x);
+	f( &x, &fx);
+	bf_chebeval( p, t, &px);
+	bf_subtract( &fx, &px, e);
+}
+
+/*  solve m linear equations in place with Gaussian elimination and
+	partial pivoting.  Matrix is m rows of m+1 FLOATs, last column
+	is the right hand side and holds the solution on return.
+	Returns 0 if matrix is singular, 1 otherwise.
+*/
+
+static int remez_solve( FLOAT *mat, int m)
+{
+	int		i, j, k, pivot, w;
+	FLOAT	temp, factor, recip, *rowk, *rowi;
+
+	w = m + 1;
+	for( k=0; k<m; k++)
+	{
+		pivot = k;
+		for( i=k+1; i<m; i++)
+			if( remez_bigger( &mat[i*w + k], &mat[pivot*w + k])) pivot = i;
+		if( bf_iszero( &mat[pivot*w + k])) return 0;
+		if( pivot != k)
+		{
+			for( j=k; j<w; j++)
+			{
+				bf_copy( &mat[k*w + j], &temp);
+				bf_copy( &mat[pivot*w + j], &mat[k*w + j]);
+				bf_copy( &temp, &mat[pivot*w + j]);
+			}
+		}
+		rowk = &mat[k*w];
+		bf_reciprical( &rowk[k], &recip);
+		for( i=k+1; i<m; i++)
+		{
+			rowi = &mat[i*w];
+			if( bf_iszero( &rowi[k])) continue;
+			bf_multiply( &rowi[k], &recip, &factor);
+			for( j=k; j<w; j++)
+			{
+				bf_multiply( &factor, &rowk[j], &temp);
+				bf_subtract( &rowi[j], &temp, &rowi[j]);
+			}
+		}
+	}
+
+/*  back substitute, solution replaces right hand side  */
+
+	for( k=m-1; k>=0; k--)
+	{
+		rowk = &mat[k*w];
+		for( j=k+1; j<m; j++)
+		{
+			bf_multiply( &rowk[j], &mat[j*w + m], &temp);
+			bf_subtract( &rowk[m], &temp, &rowk[m]);
+		}
+		bf_divide( &rowk[m], &rowk[k], &rowk[m]);
+	}
+	return 1;
+}
+
+/*  find a zero of e between lo and hi by bisection.  e must change
+	sign over the interval.  Only a rough location is needed.
+*/
+
+static void remez_zero( BF_FUNC f, CHEBSERIES p, FLOAT *mid, FLOAT *half,
+				FLOAT *lo, FLOAT *hi, FLOAT *z)
+{
+	FLOAT	a, b, c, ea, ec;
+	int		i;
+
+	bf_copy( lo, &a);
+	bf_copy( hi, &b);
+	remez_error( f, p, mid, half, &a, &ea);
+	for( i=0; i<SEARCH_LOOPS; i++)
+	{
+		bf_add( &a, &b, &c);
+		c.expnt--;
+		remez_error( f, p, mid, half, &c, &ec);
+		if( bf_iszero( &ec)) break;
+		if( (ec.mntsa.e[MS_MNTSA] ^ ea.mntsa.e[MS_MNTSA]) & SIGN_BIT)
+			bf_copy( &c, &b);
+		else
+		{
+			bf_copy( &c, &a);
+			bf_copy( &ec, &ea);
+		}
+	}
+	bf_add( &a, &b, z);
+	z->expnt--;
+}
+
+/*  find maximum of |e| between lo and hi with golden section search.
+	gold = (3 - sqrt(5))/2.  Returns location in t and error in e.
+	Error near an extremum is flat, so a rough location gives the
+	extreme value to many bits.
+*/
+
+static void remez_extreme( BF_FUNC f, CHEBSERIES p, FLOAT *mid, FLOAT *half,
+				FLOAT *gold, FLOAT *lo, FLOAT *hi, FLOAT *t, FLOAT *e)
+{
+	FLOAT	a, b, x1, x2, e1, e2, step;
+	int		i;
+
+	bf_copy( lo, &a);
+	bf_copy( hi, &b);
+	bf_subtract( &b, &a, &step);
+	bf_multiply( gold, &step, &step);
+	bf_add( &a, &step, &x1);
+	bf_subtract( &b, &step, &x2);
+	remez_error( f, p, mid, half, &x1, &e1);
+	remez_error( f, p, mid, half, &x2, &e2);
+	for( i=0; i<SEARCH_LOOPS; i++)
+	{
+		if( remez_bigger( &e2, &e1))
+		{
+			bf_copy( &x1, &a);
+			bf_copy( &x2, &x1);
+			bf_copy( &e2, &e1);
+			bf_subtract( &b, &a, &step);
+			bf_multiply( gold, &step, &step);
+			bf_subtract( &b, &step, &x2);
+			remez_error( f, p, mid, half, &x2, &e2);
+		}
+		else
+		{
+			bf_copy( &x2, &b);
+			bf_copy( &x1, &x2);
+			bf_copy( &e1, &e2);
+			bf_subtract( &b, &a, &step);
+			bf_multiply( gold, &step, &step);
+			bf_add( &a, &step, &x1);
+			remez_error( f, p, mid, half, &x1, &e1);
+		}
+	}
+	if( remez_bigger( &e2, &e1))
+	{
+		bf_copy( &x2, t);
+		bf_copy( &e2, e);
+	}
+	else
+	{
+		bf_copy( &x1, t);
+		bf_copy( &e1, e);
+	}
+}
+
+/*  compute minimax approximation to f on [a, b].
+	Enter with function pointer, interval, degree wanted and pointer
+	to where you want Chebyshev series in t.
+	Returns with maxerr = maximum absolute error found, and number of
+	exchanges used.  Returns 0 if no space or equations are singular.
+*/
+
+int bf_remez( BF_FUNC f, FLOAT *a, FLOAT *b, int degree, CHEBSERIES *p,
+			FLOAT *maxerr)
+{
+	int			i, j, m, loop;
+	MULTIPOLY	ref, mat;
+	FLOAT		mid, half, gold, PI, x, t, e, lo, hi, lvl, diff;
+	FLOAT		*rptr, *row, *cptr;
+
+	m = degree + 2;
+	ref.degree = m - 1;
+	mat.degree = m*(m+1) - 1;
+	p->degree = degree;
+	if( !bf_get_space( &ref)) return 0;
+	if( !bf_get_space( &mat))
+	{
+		bf_free_space( &ref);
+		return 0;
+	}
+	if( !bf_get_space( p))
+	{
+		bf_free_space( &ref);
+		bf_free_space( &mat);
+		return 0;
+	}
+	bf_add( b, a, &mid);
+	mid.expnt--;
+	bf_subtract( b, a, &half);
+	half.expnt--;
+	bf_int_to_float( 5, &x);
+	bf_square_root( &x, &x);
+	bf_int_to_float( 3, &gold);
+	bf_subtract( &gold, &x, &gold);
+	gold.expnt--;
+
+/*  initial reference is extrema of T(m-1, t)  */
+
+	bf_copy( &P2, &PI);
+	PI.expnt++;
+	for( i=0; i<m; i++)
+	{
+		bf_int_to_float( i, &x);
+		bf_int_to_float( m-1, &t);
+		bf_divide( &x, &t, &x);
+		bf_multiply( &PI, &x, &x);
+		rptr = Address( ref) + i;
+		bf_cosine( &x, rptr);
+		bf_negate( rptr);
+	}
+
+	for( loop=1; loop<=REMEZ_LOOPS; loop++)
+	{
+
+/*  set up equations sum{ c(j)*T(j, t(i))} + (-1)^i*E = f(x(i))  */
+
+		for( i=0; i<m; i++)
+		{
+			rptr = Address( ref) + i;
+			row = Address( mat) + i*(m+1);
+			bf_one( &row[0]);
+			if( degree > 0) bf_copy( rptr, &row[1]);
+			bf_copy( rptr, &t);
+			t.expnt++;
+			for( j=2; j<=degree; j++)
+			{
+				bf_multiply( &t, &row[j-1], &row[j]);
+				bf_subtract( &row[j], &row[j-2], &row[j]);
+			}
+			bf_one( &row[m-1]);
+			if( i & 1) bf_negate( &row[m-1]);
+			remez_map( &mid, &half, rptr, &x);
+			f( &x, &row[m]);
+		}
+		if( !remez_solve( Address( mat), m))
+		{
+			bf_free_space( &ref);
+			bf_free_space( &mat);
+			bf_free_space( p);
+			return 0;
+		}
+		for( j=0; j<=degree; j++)
+		{
+			cptr = AddressOf( p) + j;
+			bf_copy( Address( mat) + j*(m+1) + m, cptr);
+		}
+		bf_copy( Address( mat) + (m-1)*(m+1) + m, &lvl);
+
+/*  error alternates in sign on reference, so there is a zero between
+	each pair of points.  Find them, then the extreme between zeros
+	becomes new reference point.  Save zeros in the matrix space.
+*/
+		row = Address( mat);
+		for( i=0; i<m-1; i++)
+		{
+			rptr = Address( ref) + i;
+			remez_zero( f, *p, &mid, &half, rptr, rptr + 1, &row[i]);
+		}
+		bf_null( maxerr);
+		for( i=0; i<m; i++)
+		{
+			if( i) bf_copy( &row[i-1], &lo);
+			else bf_int_to_float( -1, &lo);
+			if( i < m-1) bf_copy( &row[i], &hi);
+			else bf_one( &hi);
+			rptr = Address( ref) + i;
+			remez_extreme( f, *p, &mid, &half, &gold, &lo, &hi, rptr, &e);
+
+/*  end points are often the extreme  */
+
+			if( !i || (i == m-1))
+			{
+				if( !i) bf_copy( &lo, &t);
+				else bf_copy( &hi, &t);
+				remez_error( f, *p, &mid, &half, &t, &x);
+				if( remez_bigger( &x, &e))
+				{
+					bf_copy( &t, rptr);
+					bf_copy( &x, &e);
+				}
+			}
+			if( remez_bigger( &e, maxerr)) bf_copy( &e, maxerr);
+		}
+		if( maxerr->mntsa.e[MS_MNTSA] & SIGN_BIT) bf_negate( maxerr);
+
+/*  done when extreme error is close to levelled error  */
+
+		if( lvl.mntsa.e[MS_MNTSA] & SIGN_BIT) bf_negate( &lvl);
+		bf_subtract( maxerr, &lvl, &diff);
+		if( bf_iszero( &diff) || (diff.expnt < lvl.expnt - REMEZ_TOL)) break;
+	}
+	bf_free_space( &ref);
+	bf_free_space( &mat);
+	if( loop > REMEZ_LOOPS) loop = REMEZ_LOOPS;
+	return loop;
+}
+
+/*  find lowest degree minimax approximation with absolute error
+	below 2^-bits on [a, b].  Chebyshev interpolation at maxdegree+1
+	points gives a starting degree from the size of its tail, then
+	Remez is run up or down from there.
+	Returns degree and Chebyshev series in p, or -1 if maxdegree
+	can't reach the target or no space.
+*/
+
+int bf_minimax( BF_FUNC f, FLOAT *a, FLOAT *b, int bits, int maxdegree,
+			CHEBSERIES *p)
+{
+	int			i, j, n, degree;
+	MULTIPOLY	fval, cheb;
+	CHEBSERIES	trial;
+	FLOAT		mid, half, PI, t, x, tj, tjm1, tjm2, temp, tail, err;
+	FLOAT		*fptr, *cptr;
+
+/*  Chebyshev interpolation, c(j) = 2/n * sum{ f(x(k))*T(j, t(k))}
+	with t(k) = cos( PI*(k+1/2)/n)
+*/
+	n = maxdegree + 1;
+	fval.degree = 2*n - 1;
+	cheb.degree = maxdegree;
+	if( !bf_get_space( &fval)) return -1;
+	if( !bf_get_space( &cheb))
+	{
+		bf_free_space( &fval);
+		return -1;
+	}
+	bf_add( b, a, &mid);
+	mid.expnt--;
+	bf_subtract( b, a, &half);
+	half.expnt--;
+	bf_copy( &P2, &PI);
+	PI.expnt++;
+	for( i=0; i<n; i++)
+	{
+		fptr = Address( fval) + 2*i;
+		bf_int_to_float( 2*i+1, &x);
+		bf_int_to_float( 2*n, &temp);
+		bf_divide( &x, &temp, &x);
+		bf_multiply( &PI, &x, &x);
+		bf_cosine( &x, fptr);
+		remez_map( &mid, &half, fptr, &x);
+		f( &x, fptr + 1);
+	}
+	bf_int_to_float( n, &temp);
+	for( j=0; j<=maxdegree; j++)
+	{
+		cptr = Address( cheb) + j;
+		bf_null( cptr);
+		for( i=0; i<n; i++)
+		{
+			fptr = Address( fval) + 2*i;
+
+/*  T(j, cos(u)) = cos(j*u), but recurrence on t is cheaper  */
+
+			bf_one( &tjm2);
+			bf_copy( fptr, &tjm1);
+			if( !j) bf_copy( &tjm2, &tj);
+			else bf_copy( &tjm1, &tj);
+			bf_copy( fptr, &t);
+			t.expnt++;
+			for( degree=2; degree<=j; degree++)
+			{
+				bf_multiply( &t, &tjm1, &tj);
+				bf_subtract( &tj, &tjm2, &tj);
+				bf_copy( &tjm1, &tjm2);
+				bf_copy( &tj, &tjm1);
+			}
+			bf_multiply( fptr + 1, &tj, &x);
+			bf_add( &x, cptr, cptr);
+		}
+		bf_divide( cptr, &temp, cptr);
+		cptr->expnt++;
+	}
+
+/*  smallest degree with tail sum of |c(j)| below target  */
+
+	bf_null( &tail);
+	for( degree=maxdegree; degree>0; degree--)
+	{
+		bf_copy( Address( cheb) + degree, &x);
+		if( x.mntsa.e[MS_MNTSA] & SIGN_BIT) bf_negate( &x);
+		bf_add( &x, &tail, &x);
+		if( !bf_iszero( &x) && (x.expnt > -bits)) break;
+		bf_copy( &x, &tail);
+	}
+	bf_free_space( &fval);
+	bf_free_space( &cheb);
+
+/*  walk up until target reached, then down while it still is  */
+
+	while( 1)
+	{
+		if( !bf_remez( f, a, b, degree, p, &err)) return -1;
+		if( bf_iszero( &err) || (err.expnt <= -bits)) break;
+		bf_free_space( p);
+		if( degree >= maxdegree) return -1;
+		degree++;
+	}
+	while( degree > 0)
+	{
+		if( !bf_remez( f, a, b, degree - 1, &trial, &err)) break;
+		if( !bf_iszero( &err) && (err.expnt > -bits))
+		{
+			bf_free_space( &trial);
+			break;
+		}
+		bf_free_space( p);
+		p->degree = trial.degree;
+		p->memdex = trial.memdex;
+		degree--;
+	}
+	return degree;
+}
+
+/*  convert a Chebyshev series to a power series in t so it can be
+	evaluated with bf_polyeval.  Builds T(j, t) with
+	T(j+1, t) = 2t*T(j, t) - T(j-1, t) one at a time.
+	Returns 1 if ok, 0 if no space.
+*/
+
+int bf_cheb_to_poly( CHEBSERIES c, MULTIPOLY *p)
+{
+	int			i, j;
+	MULTIPOLY	tj, tjm1;
+	FLOAT		*pptr, *cptr, *tptr, *mptr, temp;
+
+	p->degree = c.degree;
+	tj.degree = c.degree;
+	tjm1.degree = c.degree;
+	if( !bf_get_space( p)) return 0;
+	if( !bf_get_space( &tj) || !bf_get_space( &tjm1))
+	{
+		bf_free_space( p);
+		return 0;
+	}
+	for( i=0; i<=c.degree; i++)
+	{
+		bf_null( AddressOf( p) + i);
+		bf_null( Address( tj) + i);
+		bf_null( Address( tjm1) + i);
+	}
+
+/*  T(0) = 1 and T(1) = t  */
+
+	bf_one( Address( tjm1));
+	cptr = Address( c);
+	bf_copy( cptr, AddressOf( p));
+	if( c.degree > 0)
+	{
+		bf_one( Address( tj) + 1);
+		bf_copy( cptr + 1, AddressOf( p) + 1);
+	}
+	for( j=2; j<=c.degree; j++)
+	{
+
+/*  T(j) = 2t*T(j-1) - T(j-2), computed over T(j-2)  */
+
+		tptr = Address( tj);
+		mptr = Address( tjm1);
+		for( i=j; i>0; i--)
+		{
+			bf_copy( tptr + i - 1, &temp);
+			temp.expnt++;
+			bf_subtract( &temp, mptr + i, mptr + i);
+		}
+		bf_negate( mptr);
+		i = tj.memdex;
+		tj.memdex = tjm1.memdex;
+		tjm1.memdex = i;
+
+/*  add c(j)*T(j) to power series  */
+
+		cptr = Address( c) + j;
+		tptr = Address( tj);
+		pptr = AddressOf( p);
+		for( i=j; i>=0; i-=2)
+		{
+			bf_multiply( cptr, tptr + i, &temp);
+			bf_add( &temp, pptr + i, pptr + i);
+		}
+	}
+	bf_free_space( &tj);
+	bf_free_space( &tjm1);
+	return 1;
+}
+
+/*  print a table of coefficients as C source, in the same form as the
+	constants in bf_init_float, so generated approximations can be
+	compiled in as static tables.
+*/
+
+void bf_print_series( char *name, MULTIPOLY p)
+{
+	int		i, j;
+	FLOAT	*cptr;
+
+	printf("/*  %s, degree %ld  */\n", name, (long)p.degree);
+	for( i=0; i<=p.degree; i++)
+	{
+		cptr = Address( p) + i;
+		printf("\t%s[%d].expnt = %ld;\n", name, i, (long)cptr->expnt);
+		OPLOOP(j)
+			printf("\t%s[%d].mntsa.e[%d] = 0x%08lx;\n", name, i, j,
+					(unsigned long)cptr->mntsa.e[j]);
+	}
+}
+
+/*  build lowest degree minimax series for the 2^x and cos cores good
+	to 2^-bits.  The full precision series are used as the reference
+	functions and are left alone, bf_twoexp, bf_cosine and the rest
+	still use them.  bf_twoexp_bits, bf_cosine_bits, bf_sine_bits and
+	the Ziv loops pick the minimax series when it is good enough and
+	shorter than the cut down full series, saving Clenshaw steps.
+	Returns 1 if both new series are installed, replacing any from an
+	earlier call.  Returns 0 if bits is too large for this MNTSA_SIZE
+	or there is no space, nothing is changed then.
+*/
+
+static CHEBSERIES	reference;
+
+static void minimax_ref( FLOAT *x, FLOAT *y)
+{
+	bf_chebeval( reference, x, y);
+}
+
+int bf_init_minimax( int bits)
+{
+	CHEBSERIES	twox, cs;
+	FLOAT		a, b;
+
+	if( bits > 32*MNTSA_SIZE - MINIMAX_GUARD) return 0;
+	bf_int_to_float( -1, &a);
+	bf_one( &b);
+	reference = twoxcoef;
+	if( bf_minimax( minimax_ref, &a, &b, bits, twoxcoef.degree, &twox) < 0)
+		return 0;
+	reference = coscoef;
+	if( bf_minimax( minimax_ref, &a, &b, bits, coscoef.degree, &cs) < 0)
+	{
+		bf_free_space( &twox);
+		return 0;
+	}
+	if( minibits)
+	{
+		bf_free_space( &minitwox);
+		bf_free_space( &minicos);
+	}
+	minitwox = twox;
+	minicos = cs;
+	minibits = bits;
+	return 1;
+}
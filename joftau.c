@@ -40,7 +40,7 @@ main()
 	INDEX 	i, j, k, limit;
 	MULTIPOLY 	sigma3;
 	MULTIPOLY	q24, tau1, tau2;
-	MULTIPOLY	joftop, jofbot, joftau;
+	MULTIPOLY	joftop, jofbot, joftau, jseries;
 	FLOAT	*coef, *tsubj, *tnew, *prevc;
 	FLOAT	bctop, bcbottom;
 	int		shift, maxstore;
@@ -52,7 +52,7 @@ main()
 		COMPLEX start, jt;
 	} datablock;
 	FILE *svplot;
-	COMPLEX tau, jtau, arc[512], q, qn;
+	COMPLEX tau, jtau, arc[512], q;
 	FLOAT theta, dtheta;
 	COMPLEX	temp;
 	
@@ -227,6 +227,19 @@ main()
 		printfloat("joftau(i) = ", tsubj);
 	}
 */
+/*  terms past 1/q + 744 are q*sum{ joftau(k+2) * q^k }, keep those
+	coefficients as their own series for bf_polyeval_cmplx.
+*/
+
+	jseries.degree = limit - 3;
+	if( !bf_get_space( &jseries))
+	{
+		printf( "no space for j series\n");
+		exit(0);
+	}
+	for( k=0; k<=jseries.degree; k++)
+		bf_copy( Address( joftau) + k + 2, Address( jseries) + k);
+
 /*  region F is defined as | Re(tau) | < 1/2 and || tau || > 1.
 	For each point tau in F, find j(tau).
 	save binary data to disk.  Format is (x, y) and (start,
@@ -253,8 +266,7 @@ main()
 	bf_divide( &dtheta, &n, &dtheta);
 	for( i=0; i<gridsize; i++)
 	{
-		bf_cosine( &theta, &arc[i].real);
-		bf_sine( &theta, &arc[i].imag);
+		bf_sincos( &theta, &arc[i].imag, &arc[i].real);
 		bf_subtract( &theta, &dtheta, &theta);
 	}
 
@@ -282,15 +294,9 @@ main()
 			bf_firstj( &datablock.start, &q, &jtau);
 //			print_cmplx("q = exp(2 i PI tau)", &q);
 //			print_cmplx("first terms", &jtau);
-			bf_copy_cmplx( &q, &qn);
-			for( k=2; k<limit; k++)
-			{
-				offset = Address( joftau) + k;
-				bf_multiply( offset, &qn.real, &temp.real);
-				bf_multiply( offset, &qn.imag, &temp.imag);
-				bf_add_cmplx( &temp, &jtau, &jtau);
-				bf_multiply_cmplx( &q, &qn, &qn);
-			}
+			bf_polyeval_cmplx( jseries, &q, &temp);
+			bf_multiply_cmplx( &q, &temp, &temp);
+			bf_add_cmplx( &temp, &jtau, &jtau);
 			
 /*  save data point to disk  */
 
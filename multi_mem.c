@@ -20,7 +20,7 @@
 RAMDATA  ram_block[block_limit];
 
 #define POOL_SIZE	1024*1024
-FLOAT	 pool_mem[POOL_SIZE];
+FLOAT	 pool_mem[POOL_SIZE] __attribute__ ((aligned (BF_ALIGN)));
 
 #define IndexListLength	block_limit
 
@@ -74,6 +74,12 @@ int mbf_get_space( MULTIPOLY *newpoly)
 	ELEMENT  need, ramindex;
 	
 	need = (newpoly->degree + 1)*(sizeof(FLOAT)/sizeof(ELEMENT));
+
+/*  whole BF_ALIGN byte lines keep every block start aligned, crunch
+	only ever moves blocks by the sizes of other blocks.
+*/
+
+	while( (need*sizeof(FLOAT)) % BF_ALIGN) need++;
 	if( ram_block[0].size < need)
 	{
 		mbf_crunch_ram();
@@ -7,6 +7,33 @@ typedef struct
 	ELEMENT		memdex;		/*  index into ram_block array  */
 } MULTIPOLY;
 
+/*  A Chebyshev series uses the same storage as a MULTIPOLY, but
+	coefficient k multiplies T(k, x) instead of x^k.  Evaluate with
+	bf_chebeval, not bf_polyeval.
+*/
+
+typedef MULTIPOLY	CHEBSERIES;
+
+/*  A BFARRAY holds count FLOATs in one pool block, stored sideways:
+	all exponents first, then word 0 of every mantissa, then word 1
+	and so on.  Each row is ArrayStride(v) entries, count rounded up
+	to whole BF_ALIGN byte lines, and pool blocks start on a BF_ALIGN
+	boundary, so every row does too.  Batch operations in bigbatch.c
+	read a word of several values with one load.  Blocks can move
+	when ram is crunched, so always find words through these macros.
+*/
+
+typedef struct
+{
+	ELEMENT		count;		/*  number of FLOATs held  */
+	ELEMENT		memdex;		/*  index into ram_block array  */
+} BFARRAY;
+
+#define	BF_ALIGN_WORDS		(BF_ALIGN/sizeof(ELEMENT))
+#define	ArrayStride(v)		(((v).count + BF_ALIGN_WORDS - 1) & ~(BF_ALIGN_WORDS - 1))
+#define	ArrayExpnt(v)		((long *)Address(v))
+#define	ArrayWord(v, i)		((ELEMENT *)(ArrayExpnt(v) + ArrayStride(v)) + (i)*ArrayStride(v))
+
 typedef struct
 {
 	ELEMENT	flag;		/*  marks block as free or used  for crunch time */
@@ -19,13 +46,80 @@ typedef struct
 #define  Address(v)		ram_block[(v).memdex].start
 #define AddressOf(v)	ram_block[(v)->memdex].start
 
-/*  MAXCHEB determines number of Chebyshev polynomials to use and
+/*  MAXCHEB determines number of Chebyshev terms to use and
 	amounts to maximum degree of exp and cos expansions.  
 	Make even for cosine.
 */
 
 #define	MAXCHEB		54
 
+/*  widest window for integer powers, odd power table is
+	2^(INTPWR_WINDOW-1) entries.
+*/
+
+#define	INTPWR_WINDOW	4
+
+/*  exp and log use a table of 2^(j/2^EXP_TABLE_BITS).  256 entries
+	is 9K at 256 bits and leaves residuals small enough for a 20 term
+	Taylor series.
+*/
+
+#define	EXP_TABLE_BITS	8
+
+/*  At MNTSA_SIZE of BURST_MNTSA and up the fixed degree Chebyshev cores
+	can't reach full precision, so sin and cos use bit-burst evaluation
+	and the exp table is built with it.  First chunk is BURST_START bits,
+	each chunk after that doubles.
+*/
+
+#define	BURST_MNTSA		32
+#define	BURST_START		16
+#define	BURST_MAXTERMS	4096
+
+/*  bf_log switches to the AGM at MNTSA_SIZE of AGM_MNTSA and up.
+	AGM_LOOPS caps the AGM and Gauss-Legendre iterations.
+*/
+
+#define	AGM_MNTSA		32
+#define	AGM_LOOPS		32
+
+/*  complex multiply uses Gauss's 3 multiply form at MNTSA_SIZE of
+	GAUSS_MNTSA and up.  Below that the extra adds cost more than the
+	multiply saved.
+*/
+
+#define	GAUSS_MNTSA		16
+
+/*  batch multiplies work on BF_LANES values at once.  4 fills an AVX2
+	register with 64 bit products, 8 an AVX-512 one.
+*/
+
+#define	BF_LANES		4
+
+/*  pool blocks and BFARRAY rows are aligned to BF_ALIGN bytes, one
+	cache line and one AVX-512 load.  Must be a power of 2 and hold
+	a whole number of BF_LANES words.
+*/
+
+#define	BF_ALIGN		64
+
+/*  Ziv loop first tries ZIV_GUARD bits past the target.  Full length
+	arithmetic is taken as good to 32*MNTSA_SIZE - ZIV_LOSS bits, which
+	is measured, not proved.
+*/
+
+#define	ZIV_GUARD		16
+#define	ZIV_LOSS		16
+
+/*  trig reduction keeps a table of 2/PI to 32*TWOPI_WORDS bits.
+	Payne-Hanek reduction is exact for exponents up to PH_MAXEXP,
+	past that reduction loses bits same as the exponent.
+*/
+
+#define	TWOPI_WORDS	64
+#define	PH_GUARD	64
+#define	PH_MAXEXP	(32*TWOPI_WORDS - 32*MNTSA_SIZE - PH_GUARD - 32)
+
 /*
 int mbf_multi_div( MULTIPOLY Top, MULTIPOLY Bottom, 
 				MULTIPOLY *Quotient, MULTIPOLY *Remainder);